@@ -0,0 +1,112 @@
+// Benchmarks for the /proc scan against the live /proc.
+//
+//   ./bench/bench_proc_scan [max_threads] [scans] [--fd-cache]
+//       scaling of the pread backend across 1..max_threads workers
+//   ./bench/bench_proc_scan --backends [scans]
+//       syscalls and wall time per scan for each read backend; fails if a
+//       backend parses fewer processes than plain pread (e.g. when it runs
+//       out of fds under a low RLIMIT_NOFILE)
+#include "../include/process_scanner.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static int runScaling(int max_threads, int scans, bool fd_cache) {
+    if (max_threads <= 0) max_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::printf("max_threads=%d scans=%d fd_cache=%s default_threads=%d\n",
+                max_threads, scans, fd_cache ? "on" : "off", ProcessScanner::defaultThreads());
+    std::printf("%8s %10s %12s %10s\n", "threads", "pids", "ms/scan", "speedup");
+
+    double base_ms = 0.0;
+    for (int t = 1; t <= max_threads; t = (t < 4) ? t + 1 : t * 2) {
+        ProcessScanner scanner;
+        scanner.setThreads(t);
+        scanner.setFdCache(fd_cache, 0);
+        scanner.setBackend(ScanBackend::Pread);
+        scanner.scan(); // warm-up (and fd cache fill)
+
+        size_t pids = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < scans; ++i) pids = scanner.scan();
+        auto t1 = std::chrono::steady_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count() / scans;
+        if (t == 1) base_ms = ms;
+        std::printf("%8d %10zu %12.3f %9.2fx\n", t, pids, ms, base_ms / ms);
+    }
+    return 0;
+}
+
+static int runBackends(int scans) {
+    struct Variant {
+        const char* label;
+        ScanBackend backend;
+        bool fd_cache;
+    };
+    const Variant variants[] = {
+        {"pread", ScanBackend::Pread, false},
+        {"pread+fdcache", ScanBackend::Pread, true},
+        {"io_uring", ScanBackend::Uring, false},
+    };
+
+    std::printf("scans=%d\n", scans);
+    std::printf("%-14s %8s %8s %14s %12s %12s\n", "backend", "pids", "ok", "syscalls/scan", "enters/scan", "ms/scan");
+    size_t pread_ok = 0;
+    bool short_scan = false;
+    for (const Variant& v : variants) {
+        ProcessScanner scanner;
+        scanner.setThreads(1);
+        scanner.setFdCache(v.fd_cache, 0);
+        scanner.setBackend(v.backend);
+        if (scanner.backend() != v.backend) {
+            std::printf("%-14s unavailable on this kernel (falls back to pread)\n", v.label);
+            continue;
+        }
+        scanner.scan(); // warm-up: fills the fd cache where one is used
+
+        double syscalls = 0.0, enters = 0.0, ms = 0.0;
+        size_t pids = 0, ok = 0;
+        for (int i = 0; i < scans; ++i) {
+            pids = scanner.scan();
+            const ScanStats& st = scanner.lastStats();
+            syscalls += (double)st.syscalls;
+            enters += (double)st.uring_enters;
+            ms += st.wall_ms;
+            ok = 0;
+            for (const ProcScanRecord& r : scanner.records()) ok += r.ok;
+        }
+        std::printf("%-14s %8zu %8zu %14.1f %12.1f %12.3f\n", v.label, pids, ok,
+                    syscalls / scans, enters / scans, ms / scans);
+        // processes come and go between runs; a backend dropping PIDs loses
+        // far more than that
+        if (v.backend == ScanBackend::Pread && !v.fd_cache) pread_ok = ok;
+        else if (ok + 2 + pread_ok / 50 < pread_ok) short_scan = true;
+    }
+    if (short_scan) {
+        std::fprintf(stderr, "a backend parsed fewer processes than pread (%zu)\n", pread_ok);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = 0;
+    int scans = 20;
+    bool fd_cache = false;
+    bool backends = false;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--fd-cache") == 0) { fd_cache = true; continue; }
+        if (std::strcmp(argv[i], "--backends") == 0) { backends = true; continue; }
+        int v = std::atoi(argv[i]);
+        if (backends) scans = v;
+        else if (positional == 0) max_threads = v;
+        else if (positional == 1) scans = v;
+        ++positional;
+    }
+    if (scans <= 0) scans = 1;
+
+    return backends ? runBackends(scans) : runScaling(max_threads, scans, fd_cache);
+}
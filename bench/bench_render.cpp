@@ -0,0 +1,405 @@
+// Frame rendering cost, without a terminal: every panel draws onto an
+// in-memory GridSurface from a sequence of synthetic snapshots (the same
+// sequence on every run), at several terminal sizes.
+//
+//   ./bench/bench_render [frames] [--cores N] [--procs N] [--dump]
+//                        [--replay FILE] [--record FILE]
+//       µs per frame for each panel at each size; --dump prints the last
+//       frame of each size as text. --replay draws the frames of a
+//       recording (--record) instead of the synthetic ones.
+//
+// Then the exporters over the same stream: µs and bytes per snapshot for
+// the Prometheus text and a JSON line; and the recording codec: µs and
+// bytes per frame to encode, µs per frame to decode. --record FILE also
+// saves the synthetic recording.
+#include "../include/monitor.h"
+#include "../include/recording.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Deterministic snapshot stream: histories advance one sample per frame
+// (one simulated second), everything else drifts smoothly with some noise.
+class SyntheticFeed {
+public:
+    SyntheticFeed(int cores, int procs) : cores(cores), core_hist(cores) {
+        for (auto& r : core_hist) r.reset(120);
+        for (RingBuffer<float>* r : {&total_hist, &mem_hist, &swap_hist, &rd_hist, &wr_hist}) r->reset(120);
+        for (auto& r : psi_hist) r.reset(120);
+        for (int i = 0; i < kIfaces; ++i) {
+            rx_hist[i].reset(120);
+            tx_hist[i].reset(120);
+        }
+        for (RollupHistory* r : {&total_roll, &mem_roll, &swap_roll, &rd_roll, &wr_roll}) r->reset(256);
+
+        for (int i = 0; i < procs; ++i) {
+            Process p;
+            p.pid = 100 + i * 7;
+            p.name = "proc-" + std::to_string(i) + ((i % 3) ? "-worker" : "");
+            snap.processes.push_back(p);
+        }
+        const char* mounts[] = {"/", "/boot", "/home", "/var", "/srv/data", "/mnt/backup"};
+        for (int i = 0; i < 6; ++i) {
+            DiskInfo d;
+            d.device = "/dev/nvme0n1p" + std::to_string(i + 1);
+            d.mount_point = mounts[i];
+            d.total_space = 500000000UL >> i;
+            snap.disks.push_back(d);
+        }
+        const char* devs[] = {"nvme0n1", "nvme1n1", "sda", "sdb", "md0"};
+        for (int i = 0; i < 5; ++i) {
+            DiskDeviceIO d;
+            d.name = devs[i];
+            d.mount_point = (i < 4) ? mounts[i] : "/srv/data";
+            d.in_totals = (i != 2 && i != 3); // sda and sdb make up md0
+            snap.diskio.devices.push_back(d);
+        }
+        const char* ifaces[kIfaces] = {"lo", "eno1", "eno2", "docker0", "veth3f2a1"};
+        for (int i = 0; i < kIfaces; ++i) {
+            NetInterfaceIO n;
+            n.name = ifaces[i];
+            n.in_totals = (i == 1 || i == 2);
+            snap.net.interfaces.push_back(n);
+        }
+        snap.cpu.num_cores = cores;
+        snap.cpu.core_usage.assign(cores, 0.0f);
+        snap.memory.total = 32UL << 20;
+        snap.memory.swap_total = 8UL << 20;
+    }
+
+    const MonitorSnapshot& next() {
+        ++frame;
+        uint64_t now_ms = frame * 1000;
+        float total = 0.0f;
+        for (int c = 0; c < cores; ++c) {
+            float v = wave(c * 0.7, 0.05, 30.0f, 25.0f) + noise(10.0f);
+            snap.cpu.core_usage[c] = v;
+            core_hist[c].push(v);
+            total += v;
+        }
+        snap.cpu.total_usage = total / cores;
+        total_hist.push(snap.cpu.total_usage);
+        total_roll.add(snap.cpu.total_usage, now_ms);
+
+        MemoryInfo& m = snap.memory;
+        m.percent_used = wave(0.0, 0.01, 55.0f, 10.0f) + noise(1.0f);
+        m.swap_percent_used = wave(1.0, 0.003, 12.0f, 4.0f);
+        m.used = (unsigned long)(m.total * m.percent_used / 100.0f);
+        m.swap_used = (unsigned long)(m.swap_total * m.swap_percent_used / 100.0f);
+        mem_hist.push(m.percent_used);
+        swap_hist.push(m.swap_percent_used);
+        mem_roll.add(m.percent_used, now_ms);
+        swap_roll.add(m.swap_percent_used, now_ms);
+
+        DiskIOInfo& io = snap.diskio;
+        io.read_mb_per_sec = wave(2.0, 0.1, 40.0f, 38.0f) + noise(5.0f);
+        io.write_mb_per_sec = wave(3.0, 0.07, 20.0f, 18.0f) + noise(5.0f);
+        io.read_ops_per_sec = io.read_mb_per_sec * 64.0f;
+        io.write_ops_per_sec = io.write_mb_per_sec * 32.0f;
+        io.io_busy_percent = std::min(100.0f, (io.read_mb_per_sec + io.write_mb_per_sec) * 0.8f);
+        for (size_t i = 0; i < io.devices.size(); ++i) {
+            DiskDeviceIO& d = io.devices[i];
+            d.read_mb_per_sec = io.read_mb_per_sec / (i + 2) + noise(1.0f);
+            d.write_mb_per_sec = io.write_mb_per_sec / (i + 2) + noise(1.0f);
+            d.await_ms = 0.2f + noise(4.0f);
+            d.queue_depth = noise(2.0f);
+            d.util_percent = std::min(100.0f, (d.read_mb_per_sec + d.write_mb_per_sec) * 1.5f);
+        }
+        rd_hist.push(io.read_mb_per_sec);
+        wr_hist.push(io.write_mb_per_sec);
+        rd_roll.add(io.read_mb_per_sec, now_ms);
+        wr_roll.add(io.write_mb_per_sec, now_ms);
+
+        NetInfo& net = snap.net;
+        net.rx_mb_per_sec = net.tx_mb_per_sec = 0.0f;
+        net.rx_packets_per_sec = net.tx_packets_per_sec = 0.0f;
+        net.drops_per_sec = 0.0f;
+        for (int i = 0; i < kIfaces; ++i) {
+            NetInterfaceIO& n = net.interfaces[i];
+            n.rx_mb_per_sec = std::max(0.0f, wave(i * 1.3, 0.08, 30.0f / (i + 1), 25.0f / (i + 1)) + noise(2.0f));
+            n.tx_mb_per_sec = std::max(0.0f, wave(i * 0.9, 0.05, 12.0f / (i + 1), 10.0f / (i + 1)) + noise(2.0f));
+            n.rx_packets_per_sec = n.rx_mb_per_sec * 800.0f;
+            n.tx_packets_per_sec = n.tx_mb_per_sec * 700.0f;
+            n.drops_per_sec = (rnd() % 16 == 0) ? noise(5.0f) : 0.0f;
+            n.util_percent = n.in_totals ? n.rx_mb_per_sec * 8 / 10.0f : -1.0f; // 1 Gb/s links
+            rx_hist[i].push(n.rx_mb_per_sec);
+            tx_hist[i].push(n.tx_mb_per_sec);
+            n.rx_history = rx_hist[i].span();
+            n.tx_history = tx_hist[i].span();
+            if (!n.in_totals) continue;
+            net.rx_mb_per_sec += n.rx_mb_per_sec;
+            net.tx_mb_per_sec += n.tx_mb_per_sec;
+            net.rx_packets_per_sec += n.rx_packets_per_sec;
+            net.tx_packets_per_sec += n.tx_packets_per_sec;
+            net.drops_per_sec += n.drops_per_sec;
+        }
+
+        SystemInfo& sys = snap.system;
+        sys.uptime_seconds = 86400.0 * 3 + frame;
+        sys.load_1min = snap.cpu.total_usage * cores / 100.0f;
+        sys.load_5min = sys.load_1min * 0.9f;
+        sys.load_15min = sys.load_1min * 0.8f;
+        sys.ctx_switches_per_sec = 15000.0f + noise(5000.0f);
+        sys.interrupts_per_sec = 8000.0f + noise(2000.0f);
+        sys.forks_per_sec = noise(20.0f);
+        sys.procs_running = 1 + rnd() % cores;
+        sys.procs_blocked = rnd() % 3;
+
+        snap.pressure.available = true;
+        for (int r = 0; r < PsiResourceCount; ++r) {
+            PsiResource& p = snap.pressure.resource[r];
+            p.some.avg10 = std::max(0.0f, wave(r * 2.0, 0.03, 4.0f, 6.0f) + noise(2.0f));
+            p.some.avg60 = p.some.avg10 * 0.7f;
+            p.has_full = (r != PsiCPU);
+            p.full.avg10 = p.has_full ? p.some.avg10 * 0.3f : 0.0f;
+            p.full.avg60 = p.full.avg10 * 0.7f;
+            psi_hist[r].push(p.some.avg10);
+        }
+
+        // disk usage moves far slower than the refresh rate
+        if (frame % 10 == 1) {
+            for (DiskInfo& d : snap.disks) {
+                d.used_space = (unsigned long)(d.total_space * (0.4 + 0.1 * std::sin(frame * 0.01)));
+                d.free_space = d.total_space - d.used_space;
+                d.percent_used = 100.0f * d.used_space / d.total_space;
+            }
+        }
+
+        // a few processes change each frame; the list is kept sorted by CPU
+        for (size_t i = 0; i < snap.processes.size(); ++i) {
+            Process& p = snap.processes[i];
+            if (rnd() % 4 == 0) p.cpu_percent = noise(100.0f) / (1.0f + i * 0.05f);
+            p.mem_percent = 0.1f + (p.pid % 97) * 0.05f;
+        }
+        std::stable_sort(snap.processes.begin(), snap.processes.end(),
+                         [](const Process& a, const Process& b) { return a.cpu_percent > b.cpu_percent; });
+
+        snap.seq = frame;
+        snap.cpu_history.resize(cores);
+        for (int c = 0; c < cores; ++c) snap.cpu_history[c] = core_hist[c].span();
+        snap.total_history = total_hist.span();
+        snap.mem_history = mem_hist.span();
+        snap.swap_history = swap_hist.span();
+        for (int r = 0; r < PsiResourceCount; ++r) snap.psi_some_history[r] = psi_hist[r].span();
+        snap.diskio_read_history = rd_hist.span();
+        snap.diskio_write_history = wr_hist.span();
+        for (int t = 0; t < RollupHistory::kTiers; ++t) {
+            snap.total_rollup[t] = total_roll.view(t);
+            snap.mem_rollup[t] = mem_roll.view(t);
+            snap.swap_rollup[t] = swap_roll.view(t);
+            snap.diskio_read_rollup[t] = rd_roll.view(t);
+            snap.diskio_write_rollup[t] = wr_roll.view(t);
+        }
+        stampSnapshot(snap);
+        return snap;
+    }
+
+private:
+    uint32_t rnd() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    }
+    float noise(float scale) { return scale * (float)(rnd() & 0xffff) / 65536.0f; }
+    float wave(double phase, double freq, float mid, float amp) {
+        return mid + amp * (float)std::sin(phase + frame * freq);
+    }
+
+    int cores;
+    uint64_t frame = 0;
+    uint32_t seed = 12345;
+    MonitorSnapshot snap;
+    std::vector<RingBuffer<float>> core_hist;
+    RingBuffer<float> total_hist, mem_hist, swap_hist, rd_hist, wr_hist;
+    RingBuffer<float> psi_hist[PsiResourceCount];
+    static const int kIfaces = 5;
+    RingBuffer<float> rx_hist[kIfaces], tx_hist[kIfaces];
+    RollupHistory total_roll, mem_roll, swap_roll, rd_roll, wr_roll;
+};
+
+// next() returns the snapshot to draw, or null when there are no more
+template <class Next>
+static void runSize(int rows, int cols, int frames, const std::string& source, ActivityMonitor& monitor, Next next,
+                    bool dump) {
+    typedef ActivityMonitor::PanelRect PanelRect;
+    const int kPanels = ActivityMonitor::PanelCount;
+
+    PanelRect rects[kPanels];
+    ActivityMonitor::panelLayout(rows, cols, rects);
+    GridSurface grids[kPanels];
+    Surface* surfaces[kPanels];
+    for (int p = 0; p < kPanels; ++p) {
+        grids[p].resize(rects[p].h, rects[p].w);
+        surfaces[p] = &grids[p];
+    }
+
+    double sum_us[kPanels] = {};
+    double max_us[kPanels] = {};
+    double panel_us[kPanels];
+    double frame_sum = 0.0, frame_max = 0.0;
+    int f = 0;
+    for (; f < frames; ++f) {
+        const MonitorSnapshot* snap = next();
+        if (!snap) break;
+        monitor.renderPanels(*snap, surfaces, panel_us);
+        double total = 0.0;
+        for (int p = 0; p < kPanels; ++p) {
+            sum_us[p] += panel_us[p];
+            max_us[p] = std::max(max_us[p], panel_us[p]);
+            total += panel_us[p];
+        }
+        frame_sum += total;
+        frame_max = std::max(frame_max, total);
+    }
+
+    frames = std::max(1, f);
+    std::printf("%dx%d, %d frames, %s\n", cols, rows, f, source.c_str());
+    std::printf("  %-10s %12s %12s\n", "panel", "us/frame", "max us");
+    for (int p = 0; p < kPanels; ++p)
+        std::printf("  %-10s %12.2f %12.2f\n", ActivityMonitor::panelName(p), sum_us[p] / frames, max_us[p]);
+    std::printf("  %-10s %12.2f %12.2f\n", "total", frame_sum / frames, frame_max);
+
+    if (dump) {
+        GridSurface screen(rows, cols);
+        for (int p = 0; p < kPanels; ++p)
+            for (int y = 0; y < grids[p].height(); ++y)
+                for (int x = 0; x < grids[p].width(); ++x)
+                    screen.put(rects[p].y + y, rects[p].x + x, grids[p].at(y, x));
+        for (int y = 0; y < rows; ++y) std::printf("%s\n", screen.row(y).c_str());
+    }
+}
+
+static void runExport(int frames, int cores, int procs) {
+    typedef std::chrono::steady_clock Clock;
+    SyntheticFeed feed(cores, procs);
+    OutBuf out(64 * 1024);
+    double prom_us = 0.0, json_us = 0.0;
+    size_t prom_bytes = 0, json_bytes = 0;
+    for (int f = 0; f < frames; ++f) {
+        const MonitorSnapshot& snap = feed.next();
+        Clock::time_point t0 = Clock::now();
+        out.clear();
+        writePrometheus(snap, 10, out);
+        Clock::time_point t1 = Clock::now();
+        prom_bytes = out.size();
+        out.clear();
+        writeJson(snap, 10, out);
+        Clock::time_point t2 = Clock::now();
+        json_bytes = out.size();
+        prom_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        json_us += std::chrono::duration<double, std::micro>(t2 - t1).count();
+    }
+    std::printf("export, %d snapshots, top 10 processes\n", frames);
+    std::printf("  %-10s %12s %12s\n", "format", "us/snapshot", "bytes");
+    std::printf("  %-10s %12.2f %12zu\n", "prometheus", prom_us / frames, prom_bytes);
+    std::printf("  %-10s %12.2f %12zu\n", "json", json_us / frames, json_bytes);
+}
+
+// Encode the synthetic stream as a recording (one frame per simulated
+// second, every collector), then decode it back
+static bool runRecord(int frames, int cores, int procs, const char* save) {
+    typedef std::chrono::steady_clock Clock;
+    SyntheticFeed feed(cores, procs);
+    RecordEncoder encoder;
+    OutBuf file(1 << 20);
+    RecordEncoder::putHeader(file);
+    double enc_us = 0.0;
+    size_t key_bytes = 0, keys = 0;
+    for (int f = 0; f < frames; ++f) {
+        const MonitorSnapshot& snap = feed.next();
+        size_t before = file.size();
+        Clock::time_point t0 = Clock::now();
+        encoder.encode(snap, kAllCollectors, (uint64_t)f * 1000, file);
+        enc_us += std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        if (f % RecordEncoder::kKeyframeInterval == 0) {
+            key_bytes += file.size() - before;
+            ++keys;
+        }
+    }
+
+    RecordReader reader;
+    std::string error;
+    if (!reader.load(file.data(), file.size(), error)) {
+        std::fprintf(stderr, "recording does not load: %s\n", error.c_str());
+        return false;
+    }
+    MonitorSnapshot out;
+    uint32_t collectors;
+    uint64_t t_ms;
+    int decoded = 0;
+    Clock::time_point t0 = Clock::now();
+    while (reader.next(out, collectors, t_ms)) ++decoded;
+    double dec_us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    if (decoded != frames) {
+        std::fprintf(stderr, "recording decodes to %d frames of %d\n", decoded, frames);
+        return false;
+    }
+
+    size_t delta_bytes = file.size() - key_bytes;
+    std::printf("recording, %d frames, keyframe every %d\n", frames, RecordEncoder::kKeyframeInterval);
+    std::printf("  %-10s %12s %12s\n", "", "us/frame", "bytes");
+    std::printf("  %-10s %12.2f %12zu\n", "encode", enc_us / frames, file.size() / frames);
+    std::printf("  %-10s %12s %12zu\n", "keyframe", "", key_bytes / keys);
+    std::printf("  %-10s %12s %12zu\n", "delta", "", frames > (int)keys ? delta_bytes / (frames - keys) : 0);
+    std::printf("  %-10s %12.2f %12s\n", "decode", dec_us / frames, "");
+
+    if (save) {
+        FILE* fp = std::fopen(save, "wb");
+        if (!fp || std::fwrite(file.data(), 1, file.size(), fp) != file.size() || std::fclose(fp) != 0) {
+            std::fprintf(stderr, "cannot write %s\n", save);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int frames = 1000;
+    int cores = 8;
+    int procs = 300;
+    bool dump = false;
+    const char* replay = nullptr;
+    const char* record = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--cores") == 0 && i + 1 < argc) cores = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--procs") == 0 && i + 1 < argc) procs = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--dump") == 0) dump = true;
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replay = argv[++i];
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) record = argv[++i];
+        else if (std::atoi(argv[i]) > 0) frames = std::atoi(argv[i]);
+        else {
+            std::fprintf(stderr, "usage: %s [frames] [--cores N] [--procs N] [--dump] [--replay FILE] [--record FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const int sizes[][2] = {{24, 80}, {40, 140}, {60, 200}, {90, 300}};
+    for (const auto& sz : sizes) {
+        ActivityMonitor monitor;
+        if (replay) {
+            // the first frame is published by setConfig, the rest by replayNext()
+            MonitorConfig cfg;
+            cfg.replay_path = replay;
+            try {
+                monitor.setConfig(cfg);
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "%s\n", e.what());
+                return 1;
+            }
+            bool first = true;
+            runSize(sz[0], sz[1], frames, std::string("replay of ") + replay, monitor, [&]() -> const MonitorSnapshot* {
+                if (!first && !monitor.replayNext()) return nullptr;
+                first = false;
+                return &monitor.latestSnapshot();
+            }, dump);
+        } else {
+            SyntheticFeed feed(cores, procs);
+            runSize(sz[0], sz[1], frames, std::to_string(cores) + " cores, " + std::to_string(procs) + " processes",
+                    monitor, [&] { return &feed.next(); }, dump);
+        }
+    }
+    runExport(frames, cores, procs);
+    return runRecord(frames, cores, procs, record) ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+// Compares the old iostream-based /proc/<pid>/stat parsing used by
+// updateProcessInfo with the in-place parser from procfs.h, on a set of
+// recorded stat lines. Run: make bench && ./bench/bench_stat_parse [iterations]
+//
+// First it checks that readProcFile gets all of a multi-record file that
+// arrives in chunks, as seq_file procfs files do.
+#include "../include/procfs.h"
+#include "../include/net_devices.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Recorded from real hosts. Includes comm values with spaces, ')' and
+// a kernel thread, since those are the cases the old parser got wrong.
+static const char* const kRecordedLines[] = {
+    "1 (systemd) S 0 1 1 0 -1 4194560 98234 8823412 112 3402 1843 2211 40231 9012 20 0 1 0 12 175112192 3302 18446744073709551615 1 1 0 0 0 0 671173123 4096 1260 0 0 0 17 3 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "2 (kthreadd) S 0 0 0 0 -1 2129984 0 0 0 0 0 12 0 0 20 0 1 0 12 0 0 18446744073709551615 0 0 0 0 0 0 0 2147483647 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "734 (kworker/3:1H-kblockd) I 2 0 0 0 -1 69238880 0 0 0 0 0 113 0 0 0 -20 1 0 331 0 0 18446744073709551615 0 0 0 0 0 0 0 2147483647 0 0 0 0 17 3 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "1822 (Web Content) S 1540 1529 1529 0 -1 4194560 1882231 0 18 0 482113 77321 0 0 20 0 31 0 98213 3102334976 98213 18446744073709551615 94221 94882 140727 0 0 0 0 16781312 1082133752 0 0 0 17 5 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "2231 (tmux: server) S 1 2231 2231 0 -1 4194368 11823 98 0 0 9123 4412 0 0 20 0 1 0 4421 11812864 1203 18446744073709551615 1 1 0 0 0 0 0 528386 134433281 0 0 0 17 1 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "4019 (a) b) c) R 3999 4019 3999 34816 4019 4194304 212 0 0 0 7 3 0 0 20 0 1 0 771204 2703360 313 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 2 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "5120 (gcc (x86_64)) R 5100 5090 5090 34817 5090 4194304 48123 0 0 0 1182 219 0 0 20 0 1 0 804412 91234304 22013 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 7 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "88123 (java) S 1 88123 88123 0 -1 1077936384 9812331 0 412 0 88123121 1023441 0 0 20 0 412 0 9123412 48123912192 2881231 18446744073709551615 1 1 0 0 0 0 0 0 16800975 0 0 0 17 12 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+};
+
+// The parsing path updateProcessInfo used before procfs.h existed.
+static bool legacyParse(const std::string& statline, unsigned long long& utime, unsigned long long& stime) {
+    size_t pos = statline.find(')');
+    if (pos == std::string::npos) return false;
+    std::string comm = statline.substr(0, pos+1);
+    std::string rest = (pos+2 < statline.size()) ? statline.substr(pos+2) : std::string();
+    std::istringstream iss(rest);
+    std::vector<std::string> toks;
+    std::string tok;
+    while (iss >> tok) toks.push_back(tok);
+    utime = stime = 0;
+    if (toks.size() > 12) {
+        try { utime = std::stoull(toks[11]); } catch(...) { utime = 0; }
+        try { stime = std::stoull(toks[12]); } catch(...) { stime = 0; }
+    }
+    return true;
+}
+
+// Serve text through a FIFO in record-aligned chunks of at most `chunk`
+// bytes, a short read at a time like seq_file, and return what
+// read(path, buf) made of it
+template <class Read>
+static std::string chunkedRead(const std::string& text, size_t chunk, Read read) {
+    char dir[] = "/tmp/bench_stat_parseXXXXXX";
+    if (!mkdtemp(dir)) return std::string();
+    std::string path = std::string(dir) + "/file";
+    mkfifo(path.c_str(), 0600);
+    signal(SIGPIPE, SIG_IGN); // a reader that stops early closes the FIFO
+    std::thread writer([&] {
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) return;
+        for (size_t off = 0; off < text.size();) {
+            size_t end = std::min(text.size(), off + chunk);
+            if (end < text.size()) end = text.rfind('\n', end - 1) + 1; // whole records only
+            if (std::fwrite(text.data() + off, 1, end - off, f) != end - off || std::fflush(f) != 0) break;
+            off = end;
+            usleep(2000); // let the reader see the short read
+        }
+        std::fclose(f);
+    });
+    std::vector<char> buf;
+    ssize_t n = read(path.c_str(), buf);
+    writer.join();
+    unlink(path.c_str());
+    rmdir(dir);
+    return n < 0 ? std::string() : std::string(buf.data(), (size_t)n);
+}
+
+static ssize_t readWhole(const char* path, std::vector<char>& buf) {
+    buf.resize(1 << 20);
+    return readProcFile(path, buf.data(), buf.size());
+}
+
+// As the collectors read. A FIFO cannot be read twice, so the buffer
+// starts big enough; growing it is checked on real files below.
+static ssize_t readGrow(const char* path, std::vector<char>& buf) {
+    buf.resize(64 * 1024);
+    return readProcFileGrow(path, buf);
+}
+
+// Lines of text with at least `fields` space-separated fields
+static size_t countRecords(const std::string& text, int fields) {
+    std::istringstream in(text);
+    size_t records = 0;
+    for (std::string line; std::getline(in, line);) {
+        std::istringstream words(line);
+        int n = 0;
+        for (std::string w; words >> w;) ++n;
+        records += n >= fields;
+    }
+    return records;
+}
+
+// A procfs file read whole, into a buffer that has to grow, must match
+// the same file read with stdio
+static bool checkWholeRead(const char* path) {
+    std::vector<char> buf(1024);
+    ssize_t n = readProcFileGrow(path, buf);
+    FILE* f = std::fopen(path, "r");
+    if (n < 0 || !f) {
+        if (f) std::fclose(f);
+        return true; // not on this kernel
+    }
+    size_t lines = 0, ref_lines = 0;
+    for (ssize_t i = 0; i < n; ++i) lines += buf[(size_t)i] == '\n';
+    for (int c; (c = std::fgetc(f)) != EOF;) ref_lines += c == '\n';
+    std::fclose(f);
+    std::printf("read %-18s %7zd bytes %5zu lines (stdio: %zu lines)\n", path, n, lines, ref_lines);
+    return lines == ref_lines;
+}
+
+static bool checkReads() {
+    std::string text;
+    for (int i = 0; i < 400; ++i) text += "record " + std::to_string(i) + " with some padding after it\n";
+    if (chunkedRead(text, 4000, readWhole) != text) {
+        std::fprintf(stderr, "readProcFile stopped early on a %zu byte chunked file\n", text.size());
+        return false;
+    }
+
+    // /proc/diskstats on a host with many disks: every device must arrive
+    std::string diskstats;
+    for (int i = 0; i < 200; ++i) {
+        diskstats += "   8     " + std::to_string(i * 16) + " sd" + std::to_string(i) +
+                     " 81234 1021 4402312 38211 99213 20133 8812344 120331 0 88123 158542 0 0 0 0 2211 1203\n";
+    }
+    size_t disks = countRecords(chunkedRead(diskstats, 4000, readGrow), 14);
+    if (disks != 200) {
+        std::fprintf(stderr, "diskstats (%zu bytes) read as %zu of 200 devices\n", diskstats.size(), disks);
+        return false;
+    }
+    // /proc/vmstat is over 4 KB on current kernels, with the reclaim
+    // counters past the first chunk
+    std::string vmstat;
+    for (int i = 0; i < 200; ++i) vmstat += "nr_counter_" + std::to_string(i) + " " + std::to_string(i * 7919) + "\n";
+    vmstat += "pgfault 1000\npgmajfault 10\npgscan_kswapd 300\npgscan_direct 20\npgsteal_kswapd 200\n"
+              "pgsteal_direct 5\npswpin 7\npswpout 9\nworkingset_refault_anon 11\nworkingset_refault_file 13\n";
+    for (int i = 0; i < 50; ++i) vmstat += "thp_counter_" + std::to_string(i) + " 0\n";
+    std::string got = chunkedRead(vmstat, 4000, readGrow);
+    VmStatCounters vm;
+    if (!parseVmStat(got.data(), got.size(), vm) || vm.pgfault != 1000 || vm.pgscan != 320 || vm.pgsteal != 205 ||
+        vm.pswpout != 9 || vm.refault != 24) {
+        std::fprintf(stderr, "vmstat (%zu bytes) lost the counters past the first chunk\n", vmstat.size());
+        return false;
+    }
+
+    // /proc/net/dev on a container host: every veth must arrive
+    std::string netdev = "Inter-|   Receive                                                |  Transmit\n"
+                         " face |bytes    packets errs drop fifo frame compressed multicast|"
+                         "bytes    packets errs drop fifo colls carrier compressed\n";
+    for (int i = 0; i < 300; ++i) {
+        netdev += "veth" + std::to_string(100000 + i) + ": " + std::to_string(i) +
+                  "   77310    0    0    0     0          0         0 48213312   61231    0    0    0     0       0          0\n";
+    }
+    got = chunkedRead(netdev, 4000, readGrow);
+    NetInterfaceTable ifaces;
+    std::vector<NetDevCounters> counters;
+    if (!ifaces.parse(got.data(), got.size(), counters) || ifaces.interfaces().size() != 300 ||
+        counters.back().rx_bytes != 299) {
+        std::fprintf(stderr, "net/dev (%zu bytes) read as %zu of 300 interfaces\n", netdev.size(),
+                     ifaces.interfaces().size());
+        return false;
+    }
+
+    // smaps is multi-page on any process
+    return checkWholeRead("/proc/self/smaps") && checkWholeRead("/proc/diskstats") &&
+           checkWholeRead("/proc/vmstat") && checkWholeRead("/proc/net/dev");
+}
+
+int main(int argc, char* argv[]) {
+    if (!checkReads()) return 1;
+
+    long iterations = (argc > 1) ? std::atol(argv[1]) : 200000;
+    const size_t nlines = sizeof(kRecordedLines) / sizeof(kRecordedLines[0]);
+
+    std::vector<std::string> lines(kRecordedLines, kRecordedLines + nlines);
+    std::vector<size_t> lens;
+    for (auto& l : lines) lens.push_back(l.size());
+
+    // correctness check: report lines the legacy path mis-parses
+    int legacy_mismatch = 0;
+    for (size_t i = 0; i < nlines; ++i) {
+        ProcStatFields f;
+        if (!parseProcStat(lines[i].c_str(), lens[i], f)) {
+            std::fprintf(stderr, "parseProcStat failed on line %zu\n", i);
+            return 1;
+        }
+        unsigned long long lu = 0, ls = 0;
+        legacyParse(lines[i], lu, ls);
+        if (lu != f.utime || ls != f.stime) {
+            ++legacy_mismatch;
+            std::printf("legacy mismatch pid=%d comm=\"%.*s\": legacy %llu/%llu, new %llu/%llu\n",
+                        f.pid, (int)f.comm_len, f.comm, lu, ls, f.utime, f.stime);
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    unsigned long long sink = 0;
+
+    auto t0 = clock::now();
+    for (long it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < nlines; ++i) {
+            unsigned long long u, s;
+            legacyParse(lines[i], u, s);
+            sink += u + s;
+        }
+    }
+    auto t1 = clock::now();
+    for (long it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < nlines; ++i) {
+            ProcStatFields f;
+            parseProcStat(lines[i].c_str(), lens[i], f);
+            sink += f.utime + f.stime;
+        }
+    }
+    auto t2 = clock::now();
+
+    double total = (double)iterations * (double)nlines;
+    double legacy_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / total;
+    double fast_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / total;
+    std::printf("lines=%zu iterations=%ld legacy_mismatches=%d\n", nlines, iterations, legacy_mismatch);
+    std::printf("legacy (istringstream): %8.1f ns/line\n", legacy_ns);
+    std::printf("parseProcStat:          %8.1f ns/line  (%.1fx)\n", fast_ns, legacy_ns / fast_ns);
+    std::printf("(checksum %llu)\n", sink);
+    return 0;
+}
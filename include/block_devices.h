@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Cumulative /proc/diskstats counters of one device
+struct DiskCounters {
+    unsigned long long reads = 0;
+    unsigned long long read_sectors = 0;
+    unsigned long long read_ms = 0;
+    unsigned long long writes = 0;
+    unsigned long long write_sectors = 0;
+    unsigned long long write_ms = 0;
+    unsigned long long io_ms = 0;          // time with at least one I/O in flight
+    unsigned long long weighted_io_ms = 0; // time x I/Os in flight
+};
+
+// A whole disk: an entry of /sys/block (sda, nvme0n1, md0, dm-0, loop0)
+struct BlockDevice {
+    std::string name;
+    unsigned major = 0;
+    unsigned minor = 0;
+    bool member = false;  // it or a partition is part of an md/dm disk
+    bool loop = false;    // backed by a file on another filesystem
+    // Kept by the disk I/O collector: the previous sample and a filesystem
+    // mounted from the disk
+    DiskCounters last;
+    bool sampled = false;
+    std::string mount_point;
+};
+
+// Whole disks and their partitions, from /sys/block. Partitions are the
+// subdirectories of a disk that have a "partition" file, so nvme0n1, md0
+// and mmcblk0 are disks and nvme0n1p1 is not, whatever the name ends in.
+class BlockDeviceTable {
+public:
+    // Re-read /sys/block. Previous samples are kept for disks still present.
+    void scan();
+
+    std::vector<BlockDevice>& disks() { return devices; }
+    const std::vector<BlockDevice>& disks() const { return devices; }
+
+    // Index in disks() of the disk that is or holds device major:minor,
+    // or -1 if it is not a known disk or partition
+    int diskOf(unsigned major, unsigned minor) const {
+        auto it = by_dev.find(devKey(major, minor));
+        return (it == by_dev.end()) ? -1 : it->second;
+    }
+
+    // Whether the disk's I/O is counted in system totals: members of md/dm
+    // and loop devices would count the same I/O twice
+    static bool countsInTotals(const BlockDevice& d) { return !d.member && !d.loop; }
+
+private:
+    static unsigned long long devKey(unsigned major, unsigned minor) {
+        return ((unsigned long long)major << 32) | minor;
+    }
+
+    std::vector<BlockDevice> devices;
+    std::unordered_map<unsigned long long, int> by_dev; // disks and partitions
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include "surface.h"
+
+// Off-screen cell grid for a panel's plot area. A panel clears and plots
+// into it every frame, then flush() writes only the columns that differ
+// from the previous flush, so a graph update touches just the columns that
+// actually changed instead of blanking and redrawing the whole area.
+class GraphCanvas {
+public:
+    // Changing the size forgets what is on screen
+    void resize(int width, int height);
+    // The surface was erased or overwritten: rewrite every column next flush
+    void invalidate() { shown_valid = false; }
+
+    void clear();
+    void plot(int x, int row, Cell cell);
+
+    // Write the changed columns onto `out` with the grid's top-left at
+    // (y, x). Returns the number of columns written.
+    int flush(Surface& out, int y, int x);
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+private:
+    int w = 0;
+    int h = 0;
+    std::vector<Cell> cells; // column-major, current frame
+    std::vector<Cell> shown; // column-major, as last flushed
+    bool shown_valid = false;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include "out_buf.h"
+
+// Minimal non-blocking HTTP/1.1 server for the metrics endpoint. It only
+// answers GET (and HEAD) and keeps connections alive unless the client
+// asks otherwise. Everything runs on the caller's thread: the caller puts
+// pollFds() in its own poll() set and hands the results back to handle().
+// Requests larger than 8 KB, more than 64 connections and clients idle
+// for 10 s are dropped. Pipelined requests are answered one at a time:
+// the next is not parsed (nor more read) until the previous response is
+// sent, so a client that does not read cannot make its output grow.
+class HttpServer {
+public:
+    HttpServer() = default;
+    ~HttpServer();
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Bind and listen. addr is a port ("9100", bound to 127.0.0.1),
+    // host:port ("0.0.0.0:9100", "[::1]:9100") or unix:PATH. A stale Unix
+    // socket left by an earlier run is replaced; a live one is an error.
+    // Returns false with a message in error.
+    bool listen(const std::string& addr, std::string& error);
+    // Where the server listens, for messages
+    const std::string& address() const { return bound; }
+
+    // Body for a GET of path, or nullptr for 404 Not Found. The body is
+    // copied before route() is called again.
+    using Route = std::function<const OutBuf*(const char* path, size_t len)>;
+
+    // Append the fds to wait on (the listener and every connection)
+    void pollFds(std::vector<struct pollfd>& fds) const;
+    // Handle the events of the fds that pollFds() put at fds[first...]
+    void handle(const std::vector<struct pollfd>& fds, size_t first, const Route& route);
+    // poll() timeout (ms) until the next idle connection must be dropped,
+    // -1 if none
+    int timeoutMs() const;
+
+private:
+    struct Client {
+        int fd = -1;
+        std::vector<char> in;  // request bytes not yet handled
+        std::vector<char> out; // response bytes not yet sent
+        size_t sent = 0;
+        bool close_after = false;
+        uint64_t idle_deadline_ns = 0;
+    };
+    void accept();
+    // Parse and answer the first complete request in c.in, unless a
+    // response is still unsent; false to drop c
+    bool serve(Client& c, const Route& route);
+    void respond(Client& c, int status, const char* reason, const OutBuf* body, bool head);
+    // Send what is queued; false if the connection failed
+    bool flush(Client& c);
+    void drop(size_t index);
+
+    int listen_fd = -1;
+    std::string bound;
+    std::string unix_path; // unlinked on destruction
+    std::vector<Client> clients;
+};
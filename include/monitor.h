@@ -4,9 +4,41 @@
 #include <chrono>
 #include <unordered_map>
 #include <fstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <queue>
+#include "process_scanner.h"
+#include "process_table.h"
+#include "ring_buffer.h"
+#include "rollup_history.h"
+#include "triple_buffer.h"
+#include "graph_canvas.h"
+#include "surface.h"
+#include "self_stats.h"
+#include "statvfs_prober.h"
+#include "mount_table.h"
+#include "block_devices.h"
+#include "net_devices.h"
+#include "psi.h"
+#include "out_buf.h"
 
 struct MonitorConfig {
     int refresh_rate_ms = 1000;
+    // Per-collector periods in ms; 0 = refresh_rate_ms. Disk capacity and
+    // temperatures change far slower than the rest, so they run less often.
+    int cpu_period_ms = 0;
+    int memory_period_ms = 0;
+    int disks_period_ms = 10000;
+    int diskio_period_ms = 0;
+    int processes_period_ms = 0;
+    int temps_period_ms = 2000;
+    int system_period_ms = 0;
+    int pressure_period_ms = 0;
+    int net_period_ms = 0;
+    // How long the disk collector waits for statvfs before calling a mount stalled
+    int statvfs_timeout_ms = 200;
     float cpu_threshold = 80.0f;
     bool show_alert = true;
     bool system_notifications = false;
@@ -18,6 +50,40 @@ struct MonitorConfig {
     int dot_size = 2;
     // If true, aggregate logical CPUs into physical cores (pairs) for display
     bool aggregate_physical = true;
+    // Keep /proc/<pid>/stat descriptors open between refreshes
+    bool proc_fd_cache = false;
+    // Upper bound on cached descriptors (0 = derive from RLIMIT_NOFILE)
+    int proc_fd_cache_max = 0;
+    // Worker threads for the /proc scan (0 = a fraction of online CPUs)
+    int scan_threads = 0;
+    // How /proc/<pid>/stat is read: "auto" (io_uring if available), "pread" or "uring"
+    std::string io_backend = "auto";
+    // Memory (KB) shared by the 1s/10s/1m/10m rollup tiers of all graphed series
+    int history_budget_kb = 1024;
+    // Print the self-overhead report on exit
+    bool overhead_summary = false;
+    // PSI thresholds the kernel reports as they are crossed; each raises an alert
+    std::vector<PsiTriggerSpec> psi_triggers;
+    // Serve Prometheus metrics here instead of running the UI: a port,
+    // host:port or unix:PATH ("" = off)
+    std::string serve_addr;
+    // Processes the exporters include, busiest first
+    int top_processes = 10;
+    // Print one JSON object per sample to stdout instead of running the UI;
+    // stop after json_count samples (0 = until killed)
+    bool json_mode = false;
+    int json_count = 0;
+    // Append every published snapshot to this file (see recording.h)
+    std::string record_path;
+    // Drive the UI from a recording instead of the collectors, at
+    // replay_speed times the recorded pace (0 = as fast as frames draw)
+    std::string replay_path;
+    double replay_speed = 1.0;
+
+    // The period field for a scheduled collector (cpu, memory, disks,
+    // diskio, processes, temps, system, pressure, net), or nullptr for an
+    // unknown name
+    int* periodFor(const std::string& name);
 };
 
 struct CPUInfo {
@@ -41,8 +107,22 @@ struct MemoryInfo {
     unsigned long cached = 0;
     unsigned long buffers = 0;
 
-    float cache_hit_rate = -1.0f;
-    float latency_ns = -1.0f; // simulated
+    // Memory pressure from /proc/vmstat, per second over the last sample
+    float major_faults_per_sec = 0.0f;
+    float minor_faults_per_sec = 0.0f;
+    float pgscan_per_sec = 0.0f;    // pages scanned for reclaim
+    float pgsteal_per_sec = 0.0f;   // pages reclaimed
+    float swap_in_per_sec = 0.0f;   // pages
+    float swap_out_per_sec = 0.0f;
+    float refaults_per_sec = 0.0f;  // evicted pages that were needed again
+    // Share of reclaimed pages that were not faulted back in, in percent;
+    // -1 when nothing was reclaimed
+    float cache_effectiveness = -1.0f;
+};
+
+struct PressureInfo {
+    bool available = false; // /proc/pressure exists (CONFIG_PSI, not psi=0)
+    PsiResource resource[PsiResourceCount];
 };
 
 struct DiskInfo {
@@ -52,7 +132,8 @@ struct DiskInfo {
     unsigned long free_space = 0;  // KB
     unsigned long used_space = 0;  // KB
     float percent_used = 0.0f;
-    float read_latency_ms = -1.0f; // simulated
+    // statvfs missed its deadline; the sizes are the last good ones (0 if none)
+    bool stalled = false;
 };
 
 struct Process {
@@ -62,6 +143,21 @@ struct Process {
     float mem_percent = 0.0f;
 };
 
+// Fields from /proc/<pid>/status, read only when the detail view is opened
+struct ProcessDetails {
+    int pid = 0;
+    std::string name;
+    std::string state;
+    int ppid = 0;
+    int uid = 0;
+    int threads = 0;
+    unsigned long vm_size_kb = 0;
+    unsigned long vm_rss_kb = 0;
+    unsigned long vm_swap_kb = 0;
+    unsigned long long voluntary_ctxt_switches = 0;
+    unsigned long long nonvoluntary_ctxt_switches = 0;
+};
+
 struct SystemInfo {
     double uptime_seconds = 0.0;
     float load_1min = 0.0f;
@@ -73,21 +169,166 @@ struct SystemInfo {
     unsigned long long prev_interrupts = 0;
     float ctx_switches_per_sec = 0.0f;
     float interrupts_per_sec = 0.0f;
+    unsigned long long total_forks = 0;
+    unsigned long long prev_forks = 0;
+    float forks_per_sec = 0.0f;
+    unsigned long long procs_running = 0;
+    unsigned long long procs_blocked = 0;
+};
+
+// Rates of one whole disk over the last disk I/O sample
+struct DiskDeviceIO {
+    std::string name;        // sda, nvme0n1, md0, dm-0
+    std::string mount_point; // a filesystem on the disk or a partition, "" if none
+    bool in_totals = true;   // false for md/dm members and loop devices
+    float read_mb_per_sec = 0.0f;
+    float write_mb_per_sec = 0.0f;
+    float read_ops_per_sec = 0.0f;
+    float write_ops_per_sec = 0.0f;
+    float await_ms = -1.0f;     // ms per completed I/O, queueing included; -1 if none
+    float queue_depth = 0.0f;   // average I/Os in flight
+    float util_percent = 0.0f;  // time with at least one I/O in flight
 };
 
 struct DiskIOInfo {
+    // totals over the disks with in_totals set
     float read_mb_per_sec = 0.0f;
     float write_mb_per_sec = 0.0f;
     float read_ops_per_sec = 0.0f;
     float write_ops_per_sec = 0.0f;
-    float io_busy_percent = 0.0f;
-    unsigned long long prev_reads = 0;
-    unsigned long long prev_writes = 0;
-    unsigned long long prev_read_sectors = 0;
-    unsigned long long prev_write_sectors = 0;
-    unsigned long long prev_io_ticks = 0;
+    float io_busy_percent = 0.0f; // utilisation of the busiest disk
+    std::vector<DiskDeviceIO> devices; // disks that have done any I/O, diskstats order
+};
+
+// Rates of one network interface over the last sample
+struct NetInterfaceIO {
+    std::string name;
+    bool in_totals = true;  // false for loopback and virtual interfaces
+    float rx_mb_per_sec = 0.0f;
+    float tx_mb_per_sec = 0.0f;
+    float rx_packets_per_sec = 0.0f;
+    float tx_packets_per_sec = 0.0f;
+    float drops_per_sec = 0.0f;  // rx + tx
+    float errors_per_sec = 0.0f; // rx + tx
+    float util_percent = -1.0f;  // busier direction vs. link speed; -1 if unknown
+    int history_slot = -1;       // collector's history ring, -1 if none
+    Span<float> rx_history;      // MB/s
+    Span<float> tx_history;
+};
+
+struct NetInfo {
+    // totals over the interfaces with in_totals set
+    float rx_mb_per_sec = 0.0f;
+    float tx_mb_per_sec = 0.0f;
+    float rx_packets_per_sec = 0.0f;
+    float tx_packets_per_sec = 0.0f;
+    float drops_per_sec = 0.0f;
+    float errors_per_sec = 0.0f;
+    std::vector<NetInterfaceIO> interfaces; // that have seen traffic, /proc/net/dev order
 };
 
+// Collectors run by collectData(), in order; each is timed separately
+enum CollectorId {
+    CollectStat, CollectCPU, CollectMemory, CollectDisks, CollectProcesses,
+    CollectVmStat, CollectDiskIO, CollectTemps, CollectSystem, CollectPressure,
+    CollectNet, CollectorCount
+};
+const char* collectorName(int collector);
+static const uint32_t kAllCollectors = (1u << CollectorCount) - 1;
+
+// The monitor's own cost, summarised by the collector at each publish
+struct OverheadStats {
+    HistogramSummary collector_ns[CollectorCount];
+    HistogramSummary tick_ns;       // a whole collectData()
+    HistogramSummary cpu_pct_x100;  // process CPU between ticks, 1/100 %
+    HistogramSummary minor_faults;  // per tick
+    HistogramSummary syscalls;      // per tick (see SelfUsage)
+    SelfUsage usage;                // totals at the last tick
+    unsigned long page_size_kb = 4;
+};
+
+// FNV-1a accumulator for change stamps (scalars, strings, raw spans)
+struct ChangeStamp {
+    uint64_t h = 14695981039346656037ULL;
+
+    ChangeStamp& bytes(const void* p, size_t n) {
+        const unsigned char* b = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i) h = (h ^ b[i]) * 1099511628211ULL;
+        return *this;
+    }
+    template <typename T>
+    ChangeStamp& add(const T& v) { return bytes(&v, sizeof(v)); }
+    ChangeStamp& add(const std::string& s) { return bytes(s.data(), s.size()).add(s.size()); }
+};
+
+// Everything the display reads, published by the collector thread once per
+// tick. A published snapshot never changes: the history spans point into
+// history_store and rollup_store, copies of the collector's rings made at
+// publish time, not into the rings themselves. Only the rollup tier the
+// graphs show (history_tier) is filled in, with at most
+// kSnapshotRollupBuckets of its newest buckets; the other tiers are empty.
+struct MonitorSnapshot {
+    static const size_t kSnapshotRollupBuckets = 1024; // wider than any graph
+
+    uint64_t seq = 0;
+    uint64_t wall_ms = 0; // CLOCK_REALTIME at publish, ms since the epoch
+    CPUInfo cpu;
+    MemoryInfo memory;
+    SystemInfo system;
+    PressureInfo pressure;
+    DiskIOInfo diskio;
+    NetInfo net;
+    std::vector<DiskInfo> disks;
+    std::vector<Process> processes; // sorted by the sort order in effect at collection
+    std::vector<std::pair<std::string, float>> temperatures;
+    OverheadStats overhead;
+
+    std::vector<Span<float>> cpu_history; // per logical core
+    Span<float> total_history;
+    Span<float> mem_history;
+    Span<float> swap_history;
+    Span<float> majflt_history;  // per second
+    Span<float> swapio_history;  // pages in + out per second
+    Span<float> refault_history; // per second
+    Span<float> psi_some_history[PsiResourceCount]; // avg10, percent
+    Span<float> diskio_read_history;
+    Span<float> diskio_write_history;
+
+    RollupView total_rollup[RollupHistory::kTiers];
+    RollupView mem_rollup[RollupHistory::kTiers];
+    RollupView swap_rollup[RollupHistory::kTiers];
+    RollupView majflt_rollup[RollupHistory::kTiers];
+    RollupView swapio_rollup[RollupHistory::kTiers];
+    RollupView refault_rollup[RollupHistory::kTiers];
+    RollupView diskio_read_rollup[RollupHistory::kTiers];
+    RollupView diskio_write_rollup[RollupHistory::kTiers];
+
+    // What the spans above point into; reused from tick to tick
+    std::vector<float> history_store;
+    std::vector<RollupBucket> rollup_store;
+
+    // Per-section change stamps: equal stamps mean the panel built from that
+    // section would draw the same thing, so the UI can skip it
+    uint64_t cpu_stamp = 0;       // CPU values and the CPU graph histories
+    uint64_t memory_stamp = 0;    // memory values and graphs
+    uint64_t system_stamp = 0;
+    uint64_t disks_stamp = 0;
+    uint64_t diskio_stamp = 0;
+    uint64_t net_stamp = 0;
+    uint64_t processes_stamp = 0;
+};
+
+class RecordWriter;
+class RecordReader;
+
+// Fill in the change stamps of a snapshot from its contents
+void stampSnapshot(MonitorSnapshot& s);
+
+// Append the snapshot in Prometheus text format (version 0.0.4)
+void writePrometheus(const MonitorSnapshot& s, int top_processes, OutBuf& out);
+// Append the snapshot as one line of compact JSON, newline included
+void writeJson(const MonitorSnapshot& s, int top_processes, OutBuf& out);
+
 class ActivityMonitor {
 public:
     ActivityMonitor();
@@ -99,37 +340,70 @@ public:
     // Run loop
     void run();
     void runDebugMode();
-
-    // Data collection
-    void collectData();
+    // Headless Prometheus endpoint (--serve); returns on SIGINT/SIGTERM
+    void runServe();
+    // Headless JSON lines on stdout (--json)
+    void runJson();
+    // Replay (--replay): decode the next recorded frame and publish it;
+    // false at the end of the recording
+    bool replayNext();
+    // The latest published snapshot (reader side, as the UI sees it)
+    const MonitorSnapshot& latestSnapshot() { return snapshots.read(); }
+
+    // Data collection: run the collectors in the `collectors` bit mask
+    // (bit = 1 << CollectorId), in CollectorId order
+    void collectData(uint32_t collectors = kAllCollectors);
+    // Run one collector under the CLOCK_MONOTONIC timer
+    void timeCollector(int collector, void (ActivityMonitor::*update)());
+    void sampleSelfUsage();
+    void fillOverhead(OverheadStats& out) const;
+    // record = false leaves it out of --record (its collectors go in the next)
+    void publishSnapshot(bool record = true);
+    // Ask the collector thread for an immediate tick
+    void requestRefresh();
+    void readSystemStat();
     void updateCPUInfo();
     void updateMemoryInfo();
     void updateDiskInfo();
     void updateProcessInfo();
-    void updateMemoryStats();
-    void updateDiskLatency();
+    void updateVmStat();
     void updateTempInfo();
     void updateSystemInfo();
+    void updatePressure();
     void updateDiskIOInfo();
+    void updateNetInfo();
+    bool readProcessDetails(int pid, ProcessDetails& out);
 
     // Helpers
     std::string formatSize(unsigned long size_kb);
-    std::string formatLatency(float latency, bool is_memory);
     std::string createBar(float percent, int width, bool use_color = false);
 
     // UI
+    enum Panel { PanelSysInfo, PanelCPU, PanelMem, PanelDisk, PanelDiskIO, PanelNet, PanelProcess, PanelCount };
+    struct PanelRect { int y, x, h, w; };
+    static const char* panelName(int panel);
+    // Panel geometry for a terminal of rows x cols
+    static void panelLayout(int rows, int cols, PanelRect out[PanelCount]);
     void initializeWindows();
+    void layoutWindows();
+    void renderFrame();
+    // Draw the panels of `snap` onto surfaces[Panel] without a terminal (the
+    // render benchmark). panel_us, if set, receives each panel's draw time.
+    void renderPanels(const MonitorSnapshot& snap, Surface* const surfaces[PanelCount], double* panel_us = nullptr);
     void resizeWindows();
-    void displayCPUInfo();
-    void displayMemoryInfo();
-    void displayDiskInfo();
-    void displaySystemInfo();
-    void displayDiskIOInfo();
-    void displayProcessInfo();
+    void displayCPUInfo(Surface& s);
+    void displayMemoryInfo(Surface& s);
+    void displayDiskInfo(Surface& s);
+    void displaySystemInfo(Surface& s);
+    void displayDiskIOInfo(Surface& s);
+    void displayNetInfo(Surface& s);
+    void displayProcessInfo(Surface& s);
     void displayAlert();
     bool displayConfirmationDialog(const std::string& message);
     // Show an informational message dialog (waits for any key)
     void displayMessage(const std::string& message);
+    // Show /proc/<pid>/status details for one process (waits for any key)
+    void displayProcessDetails(int pid);
 
     // Actions
     bool killProcess(int pid);
@@ -140,41 +414,152 @@ public:
 
     // debug
     void debugLog(const std::string& msg);
+    // Self-overhead report (overlay, debug mode and exit summary), one
+    // string per line. Collector figures come from `collected`; panel
+    // timings are the UI thread's own.
+    void overheadReport(const OverheadStats& collected, std::vector<std::string>& out);
+    void displayOverlay(Surface& s);
 
 private:
     MonitorConfig config;
+
+    // Collector-owned state: written only by collectData() (on the collector
+    // thread once run() has started). The display reads the published copy
+    // through `view`.
     CPUInfo cpu_info;
     MemoryInfo memory_info;
     SystemInfo system_info;
+    PressureInfo pressure_info;
     DiskIOInfo diskio_info;
+    NetInfo net_info;
     std::vector<DiskInfo> disk_info;
     std::vector<Process> processes;
 
     // History buffers for sparklines
     size_t history_length = 120;
-    std::vector<std::vector<float>> cpu_history; // per-core history (percent)
-    std::vector<float> total_history;
-    std::vector<float> mem_history;
-    std::vector<float> swap_history;
+    std::vector<RingBuffer<float>> cpu_history; // per-core history (percent)
+    RingBuffer<float> total_history;
+    RingBuffer<float> mem_history;
+    RingBuffer<float> swap_history;
+    RingBuffer<float> majflt_history;
+    RingBuffer<float> swapio_history;
+    RingBuffer<float> refault_history;
+    RingBuffer<float> psi_some_history[PsiResourceCount]; // avg10 per resource
 
     // Disk I/O history
-    std::vector<float> diskio_read_history;  // MB/s
-    std::vector<float> diskio_write_history; // MB/s
+    RingBuffer<float> diskio_read_history;  // MB/s
+    RingBuffer<float> diskio_write_history; // MB/s
+
+    // Network history, one slot per interface (the first kNetHistorySlots
+    // seen). A slot freed by a vanished interface is cleared, never
+    // reallocated.
+    static const int kNetHistorySlots = 16;
+    RingBuffer<float> net_rx_history[kNetHistorySlots]; // MB/s
+    RingBuffer<float> net_tx_history[kNetHistorySlots];
+
+    // Long-term downsampled history of the same series (see RollupHistory)
+    static const size_t kRollupSeries = 8;
+    RollupHistory total_rollup;
+    RollupHistory mem_rollup;
+    RollupHistory swap_rollup;
+    RollupHistory majflt_rollup;
+    RollupHistory swapio_rollup;
+    RollupHistory refault_rollup;
+    RollupHistory diskio_read_rollup;
+    RollupHistory diskio_write_rollup;
 
     // Temperatures (label, degC)
     std::vector<std::pair<std::string, float>> temperatures;
 
+    // Self-overhead, collector side: time per collector and per tick, and
+    // this process's usage between ticks from /proc/self
+    RollingHistogram collector_hist[CollectorCount];
+    RollingHistogram tick_hist;
+    RollingHistogram self_cpu_hist;
+    RollingHistogram self_fault_hist;
+    RollingHistogram self_syscall_hist;
+    SelfUsage self_prev;
+    uint64_t self_prev_ns = 0;
+
     // ncurses windows (forward declare as void* to avoid including ncurses here)
     void* sysinfo_win = nullptr;
     void* cpu_win = nullptr;
     void* mem_win = nullptr;
     void* disk_win = nullptr;
     void* diskio_win = nullptr;
+    void* net_win = nullptr;
     void* process_win = nullptr;
     void* alert_win = nullptr;
+    // The panels draw through these (NcursesSurfaces over the windows above)
+    std::unique_ptr<Surface> panel_surfaces[PanelCount];
+
+    // Collector thread and snapshot handoff
+    TripleBuffer<MonitorSnapshot> snapshots;
+    const MonitorSnapshot* view = nullptr; // latest snapshot, UI thread only
+    uint64_t snapshot_seq = 0;
+    std::thread collector;
+    std::atomic<bool> collector_stop{false};
+    int timer_fd = -1;          // next collector deadline (timerfd, absolute)
+    int collector_wake_fd = -1; // eventfd: UI -> collector refresh request
+    int ui_wake_fd = -1;        // eventfd: collector -> UI, snapshot published
+    int winch_fd = -1;          // signalfd for SIGWINCH
+    void collectorLoop();
+    // Min-heap of the next deadline (CLOCK_MONOTONIC ns) of each scheduled
+    // collector group (see kSchedule in monitor.cpp)
+    struct ScheduledCollector {
+        uint64_t deadline_ns;
+        int group;
+        bool operator>(const ScheduledCollector& o) const { return deadline_ns > o.deadline_ns; }
+    };
+    std::priority_queue<ScheduledCollector, std::vector<ScheduledCollector>, std::greater<ScheduledCollector>> schedule;
+    int groupPeriodMs(int group) const;
+    void resetSchedule(uint64_t now_ns);
+    // Pop the groups due at now_ns, schedule their next deadline and return
+    // the collectors they run
+    uint32_t dueCollectors(uint64_t now_ns);
+    // Each collector's previous sample time, for exact rates
+    uint64_t sample_ns[CollectorCount] = {};
+    uint64_t stat_read_ns = 0; // when system_stat was read
+    double sampleInterval(int collector, uint64_t now_ns);
+    void startCollector();
+    void stopCollector();
+    // Feed one collector's fresh values into the history rings and rollups
+    void pushHistory(int collector, uint64_t now_ms);
+    // Empty every history ring and rollup, keeping their storage
+    void clearHistories();
+
+    // --record: frames go out at each recorded publish, with the collectors
+    // that ran since the previous one. --json records only what it prints.
+    std::unique_ptr<RecordWriter> recorder;
+    uint32_t collected_mask = 0;
+
+    // --replay: frames are decoded into the collector-owned state above,
+    // on the UI thread, and published as if collected. The replay clock
+    // maps recording time onto CLOCK_MONOTONIC from an origin that is
+    // moved on every seek and pause.
+    std::unique_ptr<RecordReader> replay;
+    MonitorSnapshot replay_frame;       // decode target
+    uint64_t replay_t_ms = 0;           // recording time of the frame shown
+    uint64_t replay_origin_ns = 0;
+    uint64_t replay_origin_ms = 0;
+    bool replay_paused = false;
+    std::string replay_net_names[kNetHistorySlots]; // interface in each net history slot
+    void openReplay();
+    // Decode one frame into the collector-owned state and push its history
+    // samples; false at the end
+    bool replayStep();
+    // ms until the next frame is due on the replay clock, -1 if none
+    int replayTimeoutMs() const;
+    // Publish the frames that are due; true if any were
+    bool replayTick();
+    // Jump to the start of the keyframe `direction` away ([ and ])
+    void replaySeek(int direction);
+    // Show keyframe k (history included); false if nothing decoded
+    bool replayLoad(size_t keyframe);
+    std::string replayStatus() const;
 
     bool running = true;
-    int process_sort_type = 0; // 0 = CPU, 1 = memory
+    std::atomic<int> process_sort_type{0}; // 0 = CPU, 1 = memory
     int process_list_offset = 0;
     int process_selected = 0; // index in processes vector
     
@@ -186,13 +571,35 @@ private:
     int terminal_height = 24;
     int terminal_width = 80;
 
+    // /proc/stat, read once per tick and shared by the CPU and system collectors
+    std::vector<char> proc_stat_buf;
+    SystemStatSnapshot system_stat;
+
+    // /proc/vmstat and the counters of the previous sample
+    std::vector<char> vmstat_buf;
+    VmStatCounters vmstat_prev;
+    bool vmstat_sampled = false;
+
     // for CPU delta calculations
     std::vector<unsigned long long> prev_cpu_times;
     std::vector<unsigned long long> curr_cpu_times;
     // Track idle (idle + iowait) per line in /proc/stat for accurate busy% per core
     std::vector<unsigned long long> prev_idle_times;
     std::vector<unsigned long long> curr_idle_times;
-    std::unordered_map<int, unsigned long long> prev_proc_times;
+    // persistent per-process state (CPU ticks, RSS, name) across scans
+    ProcessTable proc_table;
+    unsigned long page_size_kb = 4; // for converting stat rss pages
+    ProcessScanner proc_scanner;    // /proc walk, worker pool and stat fd cache
+    MountTable mount_table;         // real filesystems, re-read on change only
+    BlockDeviceTable block_devices; // whole disks and partitions from /sys/block
+    std::vector<char> diskstats_buf;
+    size_t diskstats_lines = 0;             // /sys/block is re-read when this changes
+    unsigned diskio_mount_generation = ~0u; // mount table the disk mounts came from
+    StatvfsProber statvfs_prober;   // statvfs with a deadline, off this thread
+    NetInterfaceTable net_interfaces; // /proc/net/dev, rebuilt when interfaces change
+    std::vector<char> netdev_buf;
+    std::vector<NetDevCounters> netdev_counters;
+    unsigned net_generation = ~0u;  // interface list the history slots were assigned for
 
     // sort helper
     void sortProcesses();
@@ -200,8 +607,9 @@ private:
     std::chrono::high_resolution_clock::time_point last_update;
     std::chrono::high_resolution_clock::time_point last_notification;
 
-    // debug file
+    // debug file (debugLog is called from both threads)
     std::ofstream debug_file;
+    std::mutex debug_mutex;
     // Terminal capabilities
     bool use_256_colors = false;
 
@@ -211,4 +619,50 @@ private:
 
     // CPU display mode: true = show per-core lines; false = show a single total CPU line
     bool cpu_mode_per_core = true;
+
+    // Time span of the CPU/memory/disk graphs: -1 = raw samples, otherwise
+    // a RollupHistory tier. Set by the UI, read by the collector at publish.
+    std::atomic<int> history_tier{-1};
+
+    // Memory panel: usage (main/swap %) or pressure (faults, swap, refaults)
+    bool mem_pressure_view = false;
+
+    // Dirty-region rendering: each panel remembers the key (snapshot stamps
+    // plus the UI state it shows) it was last drawn with and is skipped while
+    // that key is unchanged. Graphs are plotted into canvases that write
+    // only the columns that changed.
+    uint64_t panel_keys[PanelCount] = {};
+    bool panel_valid[PanelCount] = {};
+    bool panelChanged(int panel, uint64_t key);
+    void invalidatePanels();
+    void drawPanels(Surface* const surfaces[PanelCount], double* panel_us);
+    GraphCanvas cpu_canvas;
+    GraphCanvas mem_canvas;
+    uint64_t cpu_layout_key = 0;
+    uint64_t mem_layout_key = 0;
+
+    // Self-overhead, UI side: time per panel and per frame (including
+    // output); 'o' shows them over the panels
+    RollingHistogram panel_hist[PanelCount];
+    RollingHistogram frame_hist;
+    bool show_overlay = false;
+    void* overlay_win = nullptr;
+    // PSI triggers, polled by the UI loop; a firing trigger shows an alert
+    // for a few seconds
+    std::vector<int> psi_trigger_fds;
+    std::string psi_alert;
+    uint64_t psi_alert_until_ns = 0;
+    void openPsiTriggers();
+    void onPsiTrigger(size_t index);
+
+    // stdscr must be restaged under the panels (an overlay or dialog left
+    // cells in the gaps between them)
+    bool restage_screen = false;
+
+    // Frame statistics, logged in debug mode
+    int frame_panels_drawn = 0;
+    int frame_graph_cols = 0;
+    unsigned long long frame_count = 0;
+    unsigned long long frame_bytes_total = 0;
+    unsigned long long frame_writes_total = 0;
 };
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// One real filesystem from /proc/self/mountinfo
+struct MountEntry {
+    unsigned major = 0;
+    unsigned minor = 0;
+    std::string source;      // device or remote, e.g. /dev/sda1, server:/export
+    std::string mount_point;
+    std::string fs_type;
+};
+
+// Cached list of real filesystems. /proc/self/mountinfo is parsed only when
+// the kernel reports a change on it (POLLPRI), not on every tick; on a
+// container host the file can have thousands of lines. Pseudo filesystems
+// (proc, cgroup, overlay, nsfs, squashfs ...) are dropped. Bind mounts of
+// one device are collapsed to a single entry, so a caller runs statvfs
+// once per filesystem.
+//
+// Each poll() on the fd consumes the change event. A thread that puts fd()
+// in its own poll set must call markChanged() when it sees POLLPRI.
+class MountTable {
+public:
+    MountTable();
+    ~MountTable();
+    MountTable(const MountTable&) = delete;
+    MountTable& operator=(const MountTable&) = delete;
+
+    // -1 if mountinfo could not be opened (the table is then re-read on
+    // every refresh)
+    int fd() const { return mountinfo_fd; }
+    void markChanged() { changed = true; }
+
+    // Re-read the table if it changed. Returns true if it was re-read.
+    bool refresh();
+
+    const std::vector<MountEntry>& mounts() const { return entries; }
+    // Bumped on every reload, so users can cache what they derive
+    unsigned generation() const { return loads; }
+    // The mount points of mounts(), in the same order
+    const std::vector<std::string>& mountPoints() const { return points; }
+
+    static bool isPseudoFs(const std::string& fs_type);
+
+private:
+    bool load();
+
+    int mountinfo_fd = -1;
+    bool changed = true;
+    unsigned loads = 0;
+    std::vector<char> buf;
+    std::vector<MountEntry> entries;
+    std::vector<std::string> points;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Cumulative /proc/net/dev counters of one interface
+struct NetDevCounters {
+    unsigned long long rx_bytes = 0;
+    unsigned long long rx_packets = 0;
+    unsigned long long rx_errors = 0;
+    unsigned long long rx_dropped = 0;
+    unsigned long long tx_bytes = 0;
+    unsigned long long tx_packets = 0;
+    unsigned long long tx_errors = 0;
+    unsigned long long tx_dropped = 0;
+};
+
+// One network interface, in /proc/net/dev order
+struct NetInterface {
+    std::string name;
+    bool physical = false; // backed by a device (/sys/class/net/<name>/device)
+    bool loopback = false;
+    long speed_mbps = 0;   // link speed, 0 if unknown (virtual, link down)
+    // Kept by the network collector: the previous sample and a history slot
+    NetDevCounters last;
+    bool sampled = false;
+    int history_slot = -1;
+};
+
+// Interfaces of /proc/net/dev. The list, and the sysfs attributes of each
+// interface, are only rebuilt when the names in the file change; a normal
+// tick compares each line's name in place and parses its counters.
+class NetInterfaceTable {
+public:
+    // Parse a /proc/net/dev buffer. counters[i] receives the counters of
+    // interfaces()[i]. Returns false if no interface line was found.
+    bool parse(const char* buf, size_t len, std::vector<NetDevCounters>& counters);
+
+    std::vector<NetInterface>& interfaces() { return ifaces; }
+    const std::vector<NetInterface>& interfaces() const { return ifaces; }
+    // Bumped each time the list is rebuilt
+    unsigned generation() const { return rebuilds; }
+
+private:
+    void rebuild(const char* buf, size_t len);
+
+    std::vector<NetInterface> ifaces;
+    unsigned rebuilds = 0;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Append-only text buffer for the exporters (Prometheus, JSON lines).
+// Storage is reserved up front and kept across clear(), so once a render
+// has fit, rendering the next snapshot allocates nothing. Numbers are
+// formatted by hand: no snprintf, no locale, no std::to_string.
+class OutBuf {
+public:
+    explicit OutBuf(size_t reserve = 0) : buf(reserve ? reserve : 64) {}
+
+    void clear() { len = 0; }
+    const char* data() const { return buf.data(); }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    OutBuf& put(char c) {
+        if (len == buf.size()) grow(1);
+        buf[len++] = c;
+        return *this;
+    }
+    OutBuf& put(const char* s, size_t n) {
+        if (len + n > buf.size()) grow(n);
+        memcpy(buf.data() + len, s, n);
+        len += n;
+        return *this;
+    }
+    OutBuf& put(const char* s) { return put(s, strlen(s)); }
+    OutBuf& put(const std::string& s) { return put(s.data(), s.size()); }
+
+    OutBuf& putUnsigned(unsigned long long v);
+    OutBuf& putInt(long long v);
+    // v with `decimals` digits after the point (0-9), trailing zeros
+    // trimmed; NaN and infinities are written as NaN, +Inf and -Inf
+    OutBuf& putFixed(double v, int decimals = 3);
+
+private:
+    void grow(size_t need) { buf.resize(std::max(buf.size() * 2, len + need)); }
+
+    std::vector<char> buf;
+    size_t len = 0;
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "procfs.h"
+#include "uring_reader.h"
+#include "worker_pool.h"
+
+// One parsed /proc/<pid>/stat, as produced by a scan worker
+struct ProcScanRecord {
+    int pid = 0;
+    bool ok = false;
+    char comm[64];
+    unsigned char comm_len = 0;
+    unsigned long long starttime = 0;
+    unsigned long long cpu_ticks = 0; // utime + stime
+    unsigned long long rss_pages = 0;
+
+    // fd cache bookkeeping, folded back into StatFdCache after the scan
+    int cached_fd = -1;
+    int new_fd = -1;
+    bool hit = false;
+    bool dead = false;
+    bool opened = false;
+};
+
+// How the per-PID stat files are read
+enum class ScanBackend {
+    Auto,   // io_uring when the kernel allows it, otherwise pread
+    Pread,  // open/pread from the worker pool
+    Uring   // batched IORING_OP_READ on pre-opened fds
+};
+
+// Per-scan counters, for debug output and the scan benchmark. syscalls
+// counts the calls the scanner itself issues (getdents64, open, read,
+// pread, close, io_uring_enter), including closes done by the fd cache.
+struct ScanStats {
+    size_t pids = 0;
+    unsigned long syscalls = 0;
+    unsigned long uring_enters = 0;
+    double wall_ms = 0.0;
+};
+
+// Walks /proc once per scan: the PID list is gathered up front (see
+// PidEnumerator), then the stat files are read and parsed. With the pread
+// backend a worker pool takes contiguous shards, each thread writing only
+// to its own slice of records(). With io_uring the reads are submitted in
+// batches on pre-opened fds instead. Either way the result is in ascending
+// PID order.
+class ProcessScanner {
+public:
+    // 0 picks a default from the number of online CPUs
+    void setThreads(int threads);
+    int threads() const { return (int)pool.size(); }
+
+    // Keep stat fds open across scans (see StatFdCache). The io_uring
+    // backend always keeps them, since it reads from pre-opened fds. Either
+    // way a scan keeps no more than the cache limit; the PIDs beyond it are
+    // read with open/pread/close.
+    void setFdCache(bool enabled, size_t max_fds);
+    bool fdCacheEnabled() const { return use_fd_cache || active == ScanBackend::Uring; }
+    const StatFdCache& fdCache() const { return fd_cache; }
+
+    // Select the read backend. Auto and Uring probe io_uring at runtime and
+    // fall back to pread if it is unavailable or blocked by seccomp.
+    void setBackend(ScanBackend requested);
+    ScanBackend backend() const { return active; }
+    static const char* backendName(ScanBackend b);
+
+    // Run one scan. Returns the number of records; entries whose read or
+    // parse failed (the task exited mid-scan) have ok == false.
+    size_t scan();
+    const std::vector<ProcScanRecord>& records() const { return recs; }
+    const ScanStats& lastStats() const { return last_stats; }
+
+    // Default worker count: a small fraction of the online CPUs
+    static int defaultThreads();
+
+private:
+    void listPids();
+    void scanShard(size_t begin, size_t end, unsigned long& syscalls);
+    void scanUring(unsigned long& syscalls);
+    static void onUringRead(void* ctx, uint64_t index, int res);
+
+    WorkerPool pool;
+    PidEnumerator pid_enum;
+    StatFdCache fd_cache;
+    bool use_fd_cache = false;
+    // fds a scan may still open and keep for the cache: its limit minus
+    // what it holds. Shared by the pread shards, hence atomic.
+    std::atomic<long> keep_budget{0};
+    std::vector<int> pids;
+    std::vector<ProcScanRecord> recs;
+
+    ScanBackend active = ScanBackend::Pread;
+    UringReader uring;
+    std::vector<char> uring_bufs;   // one read buffer per ring entry
+    size_t uring_batch_start = 0;
+
+    std::vector<unsigned long> shard_syscalls;
+    ScanStats last_stats;
+};
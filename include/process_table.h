@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Deduplicated, reference-counted storage for process names. An index
+// stays valid while a reference to it is held; a name whose last holder
+// releases it is freed and its index reused, so the pool tracks the live
+// names rather than every name ever seen.
+class NamePool {
+public:
+    // Index of name, with one more reference taken on it
+    uint32_t intern(std::string_view name);
+    void release(uint32_t idx);
+    const std::string& get(uint32_t idx) const { return names[idx]; }
+    size_t size() const { return names.size() - free_idx.size(); }
+
+private:
+    std::deque<std::string> names; // deque keeps the views in index stable
+    std::vector<uint32_t> refs;
+    std::vector<uint32_t> free_idx;
+    std::unordered_map<std::string_view, uint32_t> index;
+};
+
+// Persistent process table kept as a struct of arrays. Slots are keyed by
+// (pid, starttime), looked up through an open-addressing pid index, and
+// removed by mark-and-sweep: every scan bumps the generation, update()
+// marks a slot as seen, and sweep() drops the rest. Removal swaps the last
+// slot into the hole, so the columns stay dense for iteration.
+class ProcessTable {
+public:
+    ProcessTable();
+
+    // Start a new scan
+    void beginScan() { ++generation; }
+
+    // Record one sample for pid. Returns the slot index and stores in
+    // delta_ticks the CPU ticks consumed since the previous scan (0 for a
+    // process seen for the first time, including a reused PID whose
+    // starttime differs from the previous owner).
+    size_t update(int pid, unsigned long long starttime, unsigned long long cpu_ticks,
+                  unsigned long long rss_kb, std::string_view name, unsigned long long& delta_ticks);
+
+    // Drop every slot not updated since beginScan()
+    void sweep();
+
+    size_t size() const { return pids.size(); }
+    const std::string& name(size_t slot) const { return name_pool.get(name_idx[slot]); }
+
+    // Columns, indexed by slot
+    std::vector<int> pids;
+    std::vector<unsigned long long> starttimes;
+    std::vector<unsigned long long> cpu_ticks;
+    std::vector<unsigned long long> rss_kb;
+    std::vector<uint32_t> name_idx;
+    std::vector<float> cpu_percent;
+
+private:
+    static constexpr int32_t kEmpty = -1;
+
+    size_t findBucket(int pid) const;
+    void insertIndex(int pid, int32_t slot);
+    void eraseIndex(int pid);
+    void growIndex();
+    size_t home(int pid) const { return ((uint32_t)pid * 2654435761u) & mask; }
+
+    std::vector<uint32_t> seen_gen;
+    uint32_t generation = 0;
+
+    // Open-addressing pid -> slot map (linear probing, backward-shift delete)
+    std::vector<int> bucket_pid;
+    std::vector<int32_t> bucket_slot;
+    size_t mask = 0;
+
+    NamePool name_pool;
+};
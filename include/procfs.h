@@ -0,0 +1,175 @@
+#pragma once
+#include <cstddef>
+#include <sys/types.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Low-level helpers for reading procfs without going through iostreams.
+// readProcFile, preadProcFd, formatProcPath, parseProcStat and parseVmStat
+// work on caller-provided buffers and never allocate. readProcFileGrow may
+// grow its vector, parseSystemStat resizes the caller's vectors, and
+// StatFdCache and PidEnumerator keep their state on the heap.
+
+// Fields decoded from a /proc/<pid>/stat line. comm points into the
+// caller's buffer (without the surrounding parentheses) and is only valid
+// while that buffer is.
+struct ProcStatFields {
+    int pid = 0;
+    const char* comm = nullptr;
+    size_t comm_len = 0;
+    char state = '?';
+    unsigned long long minflt = 0; // field 10, minor faults
+    unsigned long long utime = 0;  // field 14, clock ticks
+    unsigned long long stime = 0;  // field 15, clock ticks
+    unsigned long long starttime = 0; // field 22, ticks after boot
+    unsigned long long rss_pages = 0; // field 24, resident pages
+};
+
+// Read a whole procfs file into buf with open/read, until read() returns
+// 0. The result is NUL terminated, so at most cap-1 bytes are stored; a
+// result of cap-1 bytes may be truncated. Returns the number of bytes read
+// or -1 on error (errno is preserved). If syscalls is given, it is
+// incremented once per system call issued.
+ssize_t readProcFile(const char* path, char* buf, size_t cap, unsigned long* syscalls = nullptr);
+
+// readProcFile into a reused buffer that is doubled and the read retried
+// while the file fills it, so the result is never truncated. Same result.
+ssize_t readProcFileGrow(const char* path, std::vector<char>& buf);
+
+// Parse one /proc/<pid>/stat line in place. comm is delimited by the last
+// ')' in the line, so names containing ')' or spaces are handled.
+// Returns false if the line is truncated or malformed.
+bool parseProcStat(const char* buf, size_t len, ProcStatFields& out);
+
+// Everything the collectors need from one read of /proc/stat. The cpu
+// vectors hold the aggregate "cpu" line at index 0 followed by cpu0..N.
+struct SystemStatSnapshot {
+    std::vector<unsigned long long> cpu_total; // user+nice+system+idle+iowait+irq+softirq+steal
+    std::vector<unsigned long long> cpu_idle;  // idle + iowait
+    unsigned long long ctxt = 0;
+    unsigned long long intr_total = 0;         // first column of "intr" only
+    unsigned long long processes = 0;          // forks since boot
+    unsigned long long procs_running = 0;
+    unsigned long long procs_blocked = 0;
+};
+
+// Parse a full /proc/stat buffer in one pass. The per-IRQ columns of the
+// "intr" line (thousands on large hosts) are skipped after the total.
+// Returns false if no cpu lines were found.
+bool parseSystemStat(const char* buf, size_t len, SystemStatSnapshot& out);
+
+// Memory pressure counters from /proc/vmstat, all cumulative. Reclaim
+// sums the kswapd, direct and khugepaged variants; refaults sum anon and
+// file (kernels before 5.9 have a single workingset_refault).
+struct VmStatCounters {
+    unsigned long long pgfault = 0;    // all faults, major included
+    unsigned long long pgmajfault = 0;
+    unsigned long long pgscan = 0;     // pages scanned for reclaim
+    unsigned long long pgsteal = 0;    // pages reclaimed
+    unsigned long long pswpin = 0;     // pages
+    unsigned long long pswpout = 0;
+    unsigned long long refault = 0;    // evicted pages faulted back in
+};
+
+// Parse a full /proc/vmstat buffer. Returns false if pgfault is missing.
+bool parseVmStat(const char* buf, size_t len, VmStatCounters& out);
+
+// Decode an unsigned decimal integer starting at p. Stops at the first
+// non-digit; returns the position after the last digit consumed.
+inline const char* parseDecimal(const char* p, const char* end, unsigned long long& v) {
+    unsigned long long r = 0;
+    while (p < end && (unsigned)(*p - '0') < 10u) {
+        r = r * 10 + (unsigned)(*p - '0');
+        ++p;
+    }
+    v = r;
+    return p;
+}
+
+// Write "/proc/<pid>/<leaf>" into out (which must hold at least 32 bytes
+// plus the leaf). Returns the length written, excluding the NUL.
+size_t formatProcPath(char* out, int pid, const char* leaf);
+
+// Read an already-open /proc/<pid>/stat from offset 0 with pread. Same
+// result convention as readProcFile, except that a short read ending in a
+// newline is taken as the whole file, which only holds for single-record
+// files like stat.
+ssize_t preadProcFd(int fd, char* buf, size_t cap, unsigned long* syscalls = nullptr);
+
+// Keeps /proc/<pid>/stat open across ticks so each refresh is a single
+// pread instead of open + read + close. Entries not touched since the last
+// sweep(), or whose read fails with ESRCH (the task exited), are closed.
+class StatFdCache {
+public:
+    StatFdCache() = default;
+    ~StatFdCache();
+    StatFdCache(const StatFdCache&) = delete;
+    StatFdCache& operator=(const StatFdCache&) = delete;
+
+    // Cap the number of cached descriptors. 0 means "as many as
+    // RLIMIT_NOFILE allows"; any value is clamped to the soft limit minus
+    // some headroom for the rest of the process.
+    void setLimit(size_t max_fds);
+    size_t limit() const { return max_fds; }
+    size_t size() const { return fds.size(); }
+
+    // Scans read from several threads, so the cache is used in two phases.
+    // lookup() runs on the coordinating thread before reads are dispatched
+    // and returns the cached fd (or -1), marking the entry as seen. After
+    // the workers finish, commit() folds back what happened: hit = the
+    // cached fd was read, dead = it failed with ESRCH and must be dropped,
+    // opened = an open() was issued, new_fd = a fresh fd to keep (or -1).
+    int lookup(int pid);
+    void commit(int pid, bool hit, bool dead, bool opened, int new_fd);
+
+    // Close descriptors for PIDs that were not read since the previous
+    // sweep. Call once per scan.
+    void sweep();
+    void clear();
+
+    // Counters since the last sweep()
+    struct Stats {
+        unsigned long hits = 0;       // served by pread on a cached fd
+        unsigned long opens = 0;      // open() calls issued
+        unsigned long evictions = 0;  // fds closed (ESRCH or not seen)
+        unsigned long uncached = 0;   // reads done without caching (cap reached)
+    };
+    const Stats& lastStats() const { return last_stats; }
+
+private:
+    struct Entry {
+        int fd = -1;
+        unsigned int generation = 0;
+    };
+    std::unordered_map<int, Entry> fds;
+    size_t max_fds = 0;
+    unsigned int generation = 1;
+    Stats stats;
+    Stats last_stats;
+};
+
+// Lists the numeric entries of a procfs directory (/proc, or
+// /proc/<pid>/task for threads) with raw getdents64 calls into a reused
+// buffer, decoding names straight to integers. The directory stays open
+// between calls and is rewound each time.
+class PidEnumerator {
+public:
+    explicit PidEnumerator(const char* dir = "/proc");
+    ~PidEnumerator();
+    PidEnumerator(const PidEnumerator&) = delete;
+    PidEnumerator& operator=(const PidEnumerator&) = delete;
+
+    // Replace out with the sorted IDs. Returns false if the directory
+    // cannot be opened or read (out is left empty).
+    bool list(std::vector<int>& out);
+
+    // getdents64 calls made by the last list()
+    unsigned long lastCalls() const { return last_calls; }
+
+private:
+    std::string path;
+    int dir_fd = -1;
+    std::vector<char> buf;
+    unsigned long last_calls = 0;
+};
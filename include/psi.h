@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Pressure stall information (/proc/pressure/*, Linux 4.20+). "some" is
+// the share of time at least one task was stalled on the resource, "full"
+// the share of time all non-idle tasks were.
+enum PsiResourceId { PsiCPU, PsiMemory, PsiIO, PsiResourceCount };
+const char* psiResourceName(int resource); // "cpu", "memory", "io"
+
+struct PsiAverages {
+    float avg10 = 0.0f; // percent
+    float avg60 = 0.0f;
+    float avg300 = 0.0f;
+    unsigned long long total_us = 0;
+};
+
+struct PsiResource {
+    PsiAverages some;
+    PsiAverages full;
+    bool has_full = false;
+};
+
+// Parse one /proc/pressure/<resource> file. Returns false without a
+// "some" line.
+bool parsePressure(const char* buf, size_t len, PsiResource& out);
+
+// A PSI trigger: wake when tasks stall for stall_ms within any window_ms
+struct PsiTriggerSpec {
+    int resource = PsiMemory;
+    bool full = false;
+    int stall_ms = 0;
+    int window_ms = 1000;
+};
+
+// "memory:some:150[:1000]" (resource:some|full:stall_ms[:window_ms])
+bool parsePsiTriggerSpec(const std::string& text, PsiTriggerSpec& out);
+std::string describePsiTrigger(const PsiTriggerSpec& spec); // "memory some 150ms/1000ms"
+
+// Register a trigger with the kernel. The returned fd signals POLLPRI each
+// time the threshold is crossed (at most once per window); close it to
+// remove the trigger. Returns -1 with errno set on failure.
+int openPsiTrigger(const PsiTriggerSpec& spec);
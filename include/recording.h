@@ -0,0 +1,184 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "out_buf.h"
+
+struct MonitorSnapshot;
+struct Process;
+
+// Binary recording of published snapshots (--record, --replay).
+//
+//   file   = "AMREC\x1a\n", version (1 byte), records
+//   record = type (1 byte), payload length (varint), payload
+//     'S'  one string-table entry (a process, device, mount or sensor
+//          name). Entries are numbered from 0 in file order and written
+//          just before the first frame that uses them.
+//     'K'  keyframe: decodes without any earlier frame
+//     'D'  delta frame: every number is the difference from the same
+//          field of the previous frame
+//   frame  = time (varint ms since the first frame; in a delta frame,
+//            since the previous frame), the CollectorId bits that ran
+//            (varint), then the snapshot fields
+//
+// Integers are stored exactly, floats in fixed point (1/1000); both as
+// zigzag varints, so a field that did not change takes one byte.
+// Processes go in PID order and are matched to the previous frame by PID;
+// the name is only written when it is new or changed. Histories are not
+// stored: a replay rebuilds them from the frames, as the collectors did.
+// The overhead figures are not recorded.
+static const unsigned kRecordVersion = 1;
+
+class RecordEncoder {
+public:
+    static const int kKeyframeInterval = 60; // frames
+
+    // Append the file header
+    static void putHeader(OutBuf& out);
+    // Append the records of one frame (new strings, then the frame).
+    // t_ms is any millisecond clock; the first frame is time 0.
+    void encode(const MonitorSnapshot& s, uint32_t collectors, uint64_t t_ms, OutBuf& out);
+
+    // Field visitor for walkFrame() (recording.cpp)
+    void integer(int64_t v);
+    void real(double v);
+    void str(const std::string& s);
+    template <class T, class F>
+    void list(const std::vector<T>& v, F each) {
+        integer((int64_t)v.size());
+        for (const T& e : v) each(e);
+    }
+    void procs(const std::vector<Process>& p);
+
+private:
+    struct ProcState {
+        int pid;
+        uint32_t name;
+        int64_t cpu, mem;
+    };
+    uint32_t stringId(const std::string& s);
+
+    std::unordered_map<std::string, uint32_t> strings;
+    std::vector<int64_t> prev; // every field of the previous frame, in order
+    std::vector<ProcState> prev_procs, cur_procs; // PID order
+    std::vector<uint32_t> order;
+    OutBuf payload{4096};
+    OutBuf new_strings{256};
+    size_t field = 0;
+    bool keyframe = true;
+    uint64_t frames = 0;
+    uint64_t first_t = 0;
+    uint64_t last_t = 0;
+};
+
+// Appends frames to a recording file, one write() per frame, so a crash
+// loses at most the frame being written
+class RecordWriter {
+public:
+    RecordWriter() = default;
+    ~RecordWriter();
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    // Create (or truncate) path and write the header; false with a message
+    bool open(const std::string& path, std::string& error);
+    // false if the write failed (errno set)
+    bool append(const MonitorSnapshot& s, uint32_t collectors, uint64_t t_ms);
+
+private:
+    int fd = -1;
+    RecordEncoder encoder;
+    OutBuf out{8192};
+};
+
+// Reads a recording. The file is mapped and scanned once on open for the
+// string table and the keyframes; frames are decoded on demand. A
+// truncated last record (a recording cut short) is ignored.
+class RecordReader {
+public:
+    RecordReader() = default;
+    ~RecordReader();
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+
+    // Map and scan a file; false with a message
+    bool open(const std::string& path, std::string& error);
+    // Scan a recording already in memory (not copied; must outlive the reader)
+    bool load(const char* data, size_t len, std::string& error);
+
+    size_t frames() const { return frame_count; }
+    size_t keyframes() const { return keys.size(); }
+    size_t keyframeFrame(size_t k) const { return keys[k].frame; }
+    // The last keyframe at or before frame
+    size_t keyframeBefore(size_t frame) const;
+    uint64_t durationMs() const { return duration_ms; }
+
+    // Index of the frame next() decodes
+    size_t position() const { return frame; }
+    void seek(size_t keyframe);
+    // Time of the frame next() decodes; false at the end
+    bool peekTime(uint64_t& t_ms) const;
+    // Decode the next frame into out: wall_ms, cpu, memory, system,
+    // pressure, diskio, net, disks, processes (PID order) and temperatures.
+    // Nothing else in out is touched. False at the end or on a corrupt frame.
+    bool next(MonitorSnapshot& out, uint32_t& collectors, uint64_t& t_ms);
+
+    // Field visitor for walkFrame() (recording.cpp)
+    template <class T>
+    void integer(T& v) { v = (T)field(); }
+    template <class T>
+    void real(T& v) { v = (T)((double)field() / 1000.0); }
+    void str(std::string& s);
+    template <class T, class F>
+    void list(std::vector<T>& v, F each) {
+        size_t n = 0;
+        integer(n);
+        if (bad || n > (size_t)(end - p)) { // every element takes a byte at least
+            bad = true;
+            n = 0;
+        }
+        v.resize(n);
+        for (T& e : v) each(e);
+    }
+    void procs(std::vector<Process>& out);
+
+private:
+    struct Keyframe {
+        size_t offset; // of the record
+        size_t frame;
+        uint64_t t_ms;
+    };
+    struct ProcState {
+        int pid;
+        uint32_t name;
+        int64_t cpu, mem;
+    };
+    // Next frame record at or after `at`: its type, payload bounds and the
+    // offset after it; false if none
+    bool nextFrameRecord(size_t at, char& type, const char*& body, const char*& body_end, size_t& after) const;
+    uint64_t varint();
+    int64_t field();
+
+    void* map = nullptr;
+    size_t map_len = 0;
+    const char* data = nullptr;
+    size_t len = 0; // up to the end of the last complete record
+    std::vector<std::string> strings;
+    std::vector<Keyframe> keys;
+    size_t frame_count = 0;
+    uint64_t duration_ms = 0;
+
+    // decoder state
+    size_t off = 0;   // next record
+    size_t frame = 0; // next frame
+    uint64_t last_t = 0;
+    const char* p = nullptr;
+    const char* end = nullptr;
+    bool bad = false;
+    bool keyframe = true;
+    size_t field_index = 0;
+    std::vector<int64_t> prev;
+    std::vector<ProcState> prev_procs, cur_procs;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Read-only view of contiguous elements, oldest first
+template <typename T>
+struct Span {
+    const T* ptr = nullptr;
+    size_t len = 0;
+
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + len; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    const T& back() const { return ptr[len - 1]; }
+};
+
+// Fixed-capacity history buffer with O(1) push. Storage is mirrored (each
+// element is written at i and i + capacity), so the newest size() samples
+// are always one contiguous run and span() never copies.
+//
+// One writer may push while other threads read: elements are written
+// before the count is published with release ordering, and readers load it
+// with acquire. A reader that overlaps a push can see its oldest element
+// replaced by the newest one; everything else in its span is stable.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity = 0) { reset(capacity); }
+
+    RingBuffer(RingBuffer&& o) noexcept
+        : data(std::move(o.data)), cap(o.cap), pushed(o.pushed.load(std::memory_order_relaxed)) {
+        o.cap = 0;
+        o.pushed.store(0, std::memory_order_relaxed);
+    }
+    RingBuffer& operator=(RingBuffer&& o) noexcept {
+        data = std::move(o.data);
+        cap = o.cap;
+        pushed.store(o.pushed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        o.cap = 0;
+        o.pushed.store(0, std::memory_order_relaxed);
+        return *this;
+    }
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Drop all samples and change the capacity (writer side only)
+    void reset(size_t capacity) {
+        cap = capacity;
+        data.reset(capacity ? new T[capacity * 2]() : nullptr);
+        pushed.store(0, std::memory_order_release);
+    }
+
+    // Drop all samples but keep the storage, so spans taken earlier still
+    // point at valid memory (writer side only)
+    void clear() { pushed.store(0, std::memory_order_release); }
+
+    void push(const T& v) {
+        if (cap == 0) return;
+        size_t n = pushed.load(std::memory_order_relaxed);
+        size_t w = n % cap;
+        data[w] = v;
+        data[w + cap] = v;
+        pushed.store(n + 1, std::memory_order_release);
+    }
+
+    size_t capacity() const { return cap; }
+    size_t size() const {
+        size_t n = pushed.load(std::memory_order_acquire);
+        return n < cap ? n : cap;
+    }
+    bool empty() const { return size() == 0; }
+
+    // The retained samples, oldest first
+    Span<T> span() const {
+        size_t n = pushed.load(std::memory_order_acquire);
+        size_t len = n < cap ? n : cap;
+        if (len == 0) return Span<T>();
+        size_t start = (n - len) % cap;
+        return Span<T>{data.get() + start, len};
+    }
+
+    // i-th retained sample, oldest first
+    const T& operator[](size_t i) const { return span()[i]; }
+    const T& back() const { return span().back(); }
+
+private:
+    std::unique_ptr<T[]> data;
+    size_t cap = 0;
+    std::atomic<size_t> pushed{0}; // total pushes since reset
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "ring_buffer.h"
+
+// One downsampled interval of a series
+struct RollupBucket {
+    float min = 0.0f;
+    float max = 0.0f;
+    float avg = 0.0f;
+};
+
+// Buckets of one tier, oldest first; the still-open bucket (partial
+// aggregate of the current interval) is appended as the last element.
+struct RollupView {
+    Span<RollupBucket> closed;
+    RollupBucket open;
+    bool has_open = false;
+
+    size_t size() const { return closed.size() + (has_open ? 1 : 0); }
+    bool empty() const { return size() == 0; }
+    const RollupBucket& operator[](size_t i) const { return i < closed.size() ? closed[i] : open; }
+};
+
+// Tiered long-term history for one series. Every sample is folded into the
+// open bucket of each tier as it arrives; a bucket is closed into that
+// tier's ring when a sample lands in a later interval, so no tier is ever
+// recomputed from raw samples.
+class RollupHistory {
+public:
+    static constexpr int kTiers = 4;
+    static constexpr uint64_t kPeriodMs[kTiers] = {1000, 10000, 60000, 600000};
+    static const char* tierName(int tier) {
+        static const char* const names[kTiers] = {"1s", "10s", "1m", "10m"};
+        return (tier >= 0 && tier < kTiers) ? names[tier] : "raw";
+    }
+
+    // Buckets per tier so that `series` histories fit in budget_bytes
+    static size_t bucketsForBudget(size_t budget_bytes, size_t series) {
+        // each ring stores its buckets twice (see RingBuffer)
+        size_t per_bucket = 2 * sizeof(RollupBucket) * kTiers * (series ? series : 1);
+        size_t n = budget_bytes / per_bucket;
+        return n < 16 ? 16 : n;
+    }
+
+    // Drop everything and keep `buckets` closed buckets per tier
+    void reset(size_t buckets) {
+        for (int t = 0; t < kTiers; ++t) {
+            rings[t].reset(buckets);
+            open[t] = Accum();
+        }
+    }
+
+    // Drop everything but keep the storage, so views taken earlier still
+    // point at valid memory
+    void clear() {
+        for (int t = 0; t < kTiers; ++t) {
+            rings[t].clear();
+            open[t] = Accum();
+        }
+    }
+
+    void add(float v, uint64_t now_ms) {
+        for (int t = 0; t < kTiers; ++t) {
+            Accum& a = open[t];
+            uint64_t bucket = now_ms / kPeriodMs[t];
+            if (a.count && bucket != a.bucket) {
+                rings[t].push(a.finish());
+                a = Accum();
+            }
+            if (a.count == 0) {
+                a.bucket = bucket;
+                a.min = a.max = v;
+            } else {
+                if (v < a.min) a.min = v;
+                if (v > a.max) a.max = v;
+            }
+            a.sum += v;
+            ++a.count;
+        }
+    }
+
+    RollupView view(int tier) const {
+        RollupView v;
+        v.closed = rings[tier].span();
+        v.has_open = open[tier].count > 0;
+        if (v.has_open) v.open = open[tier].finish();
+        return v;
+    }
+
+    size_t capacity() const { return rings[0].capacity(); }
+
+private:
+    struct Accum {
+        uint64_t bucket = 0;
+        float min = 0.0f;
+        float max = 0.0f;
+        double sum = 0.0;
+        unsigned count = 0;
+
+        RollupBucket finish() const {
+            RollupBucket b;
+            b.min = min;
+            b.max = max;
+            b.avg = count ? (float)(sum / count) : 0.0f;
+            return b;
+        }
+    };
+
+    RingBuffer<RollupBucket> rings[kTiers];
+    Accum open[kTiers];
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <time.h>
+
+// CLOCK_MONOTONIC in nanoseconds, for timing collectors and panels
+inline uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Distribution of the samples currently in a RollingHistogram window.
+// Percentiles are bucket midpoints (within ~12% of the true value); mean
+// and max are exact.
+struct HistogramSummary {
+    uint32_t n = 0;
+    uint64_t total = 0; // samples ever added
+    double mean = 0.0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+};
+
+// Histogram of the last kWindow samples. Buckets are log-linear: four per
+// power of two, so any uint64 value fits in 252 buckets. add() is O(1): the
+// sample that falls out of the window is taken out of its bucket.
+class RollingHistogram {
+public:
+    static const size_t kWindow = 256;
+    static const int kBuckets = 252;
+
+    void add(uint64_t v) {
+        if (filled == kWindow) {
+            uint64_t old = window[pos];
+            --counts[bucketOf(old)];
+            sum -= old;
+        } else {
+            ++filled;
+        }
+        window[pos] = v;
+        pos = (pos + 1) % kWindow;
+        ++counts[bucketOf(v)];
+        sum += v;
+        ++total;
+    }
+
+    void clear() { *this = RollingHistogram(); }
+
+    HistogramSummary summary() const {
+        HistogramSummary s;
+        s.n = (uint32_t)filled;
+        s.total = total;
+        if (filled == 0) return s;
+        s.mean = (double)sum / filled;
+        for (size_t i = 0; i < filled; ++i)
+            if (window[i] > s.max) s.max = window[i];
+        s.p50 = percentile(50);
+        s.p99 = percentile(99);
+        if (s.p50 > s.max) s.p50 = s.max;
+        if (s.p99 > s.max) s.p99 = s.max;
+        return s;
+    }
+
+    static int bucketOf(uint64_t v) {
+        if (v < 4) return (int)v;
+        int octave = 63 - __builtin_clzll(v); // >= 2
+        return 4 * (octave - 1) + (int)((v >> (octave - 2)) & 3);
+    }
+    static uint64_t bucketLow(int b) {
+        if (b < 4) return (uint64_t)b;
+        int octave = b / 4 + 1;
+        return (uint64_t)(4 + b % 4) << (octave - 2);
+    }
+
+private:
+    uint64_t percentile(int pct) const {
+        size_t rank = (filled * pct + 99) / 100; // 1-based, rounded up
+        if (rank == 0) rank = 1;
+        size_t seen = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            seen += counts[b];
+            if (seen >= rank) {
+                uint64_t lo = bucketLow(b);
+                uint64_t hi = (b + 1 < kBuckets) ? bucketLow(b + 1) : lo;
+                return lo + (hi - lo) / 2;
+            }
+        }
+        return 0;
+    }
+
+    uint64_t window[kWindow] = {};
+    uint16_t counts[kBuckets] = {};
+    size_t pos = 0;
+    size_t filled = 0;
+    uint64_t sum = 0;
+    uint64_t total = 0;
+};
+
+// The monitor's own resource use, from /proc/self/stat and /proc/self/io
+struct SelfUsage {
+    unsigned long long cpu_ticks = 0;    // utime + stime, clock ticks
+    unsigned long long rss_pages = 0;
+    unsigned long long minor_faults = 0;
+    // syscr + syscw: read- and write-family calls only, so a lower bound on
+    // the real syscall count (poll, open, ioctl ... are not counted)
+    unsigned long long syscalls = 0;
+};
+
+// Returns false if /proc/self/stat cannot be read or parsed
+bool readSelfUsage(SelfUsage& out);
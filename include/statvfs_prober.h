@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Filesystem sizes in KB, as last reported by statvfs
+struct FsSpace {
+    unsigned long total_kb = 0;
+    unsigned long free_kb = 0;
+};
+
+// Runs statvfs off the collector thread so a hung NFS/FUSE mount cannot
+// freeze the monitor. Each refresh() queues one call per mount that is not
+// already outstanding or backing off and waits for them up to the timeout.
+// A call that has been running longer than the timeout marks the mount
+// stalled; a call still queued does not. A stalled mount is not probed
+// again until its backoff (5 s, doubling up to 5 min) has passed and the
+// stuck call has returned. Until then the last good values stay in the
+// cache.
+//
+// Calls run on detached helper threads, not on the WorkerPool: a thread
+// stuck in the kernel can never be joined, so the destructor only tells
+// the helpers to exit once their call returns. At most max_threads helpers
+// are working; one stuck past its deadline no longer counts, so a
+// replacement serves the other mounts, up to 4 * max_threads in all.
+class StatvfsProber {
+public:
+    struct Entry {
+        FsSpace space;
+        bool valid = false;   // space holds a successful result
+        bool failed = false;  // the last completed call returned an error
+        bool stalled = false; // a call is outstanding past its deadline
+        unsigned stalls = 0;  // consecutive calls that missed the deadline
+        uint64_t retry_ns = 0;
+    };
+
+    explicit StatvfsProber(int max_threads = 4);
+    ~StatvfsProber();
+    StatvfsProber(const StatvfsProber&) = delete;
+    StatvfsProber& operator=(const StatvfsProber&) = delete;
+
+    void setTimeout(int ms) { timeout_ms = ms > 0 ? ms : 1; }
+
+    // Probe `paths` (mount points) and forget mounts no longer listed
+    void refresh(const std::vector<std::string>& paths);
+
+    // State of a mount after the last refresh(), or nullptr if unknown
+    const Entry* find(const std::string& path) const;
+
+private:
+    struct Job;
+    struct Shared;
+    struct Mount {
+        Entry entry;
+        std::shared_ptr<Job> job; // outstanding call
+    };
+    void harvest(Mount& m, bool in_time);
+    void spawnHelpers();
+    static void helperMain(std::shared_ptr<Shared> shared);
+
+    std::shared_ptr<Shared> shared;
+    std::unordered_map<std::string, Mount> mounts;
+    int max_threads;
+    int timeout_ms = 200;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What the panels draw on. NcursesSurface writes into an ncurses window;
+// GridSurface keeps an in-memory character/attribute grid, so the panels can
+// be rendered (and timed) without a terminal. Both clip at the edges: text
+// never wraps and out-of-range cells are ignored.
+
+// Non-ASCII cells; each backend maps them to its own representation
+enum class Glyph : uint8_t { Bullet = 1, Checkerboard, VLine, HLine, ULCorner, URCorner, LLCorner, LRCorner };
+
+// Style attribute bits
+enum : uint8_t { AttrBold = 1, AttrDim = 2, AttrReverse = 4 };
+
+// Color pair (as registered in initializeWindows, 0 = default) and attributes
+struct Style {
+    uint8_t pair = 0;
+    uint8_t attrs = 0;
+
+    Style() = default;
+    Style(int color_pair, int attributes = 0) : pair((uint8_t)color_pair), attrs((uint8_t)attributes) {}
+};
+
+// One cell packed into 32 bits: character or Glyph (bits 0-7, bit 8 set for
+// a glyph), color pair (16-23) and attributes (24-31)
+using Cell = uint32_t;
+static const Cell kCellGlyph = 1u << 8;
+
+inline Cell makeCell(char ch, Style st = Style()) {
+    return (Cell)(unsigned char)ch | ((Cell)st.pair << 16) | ((Cell)st.attrs << 24);
+}
+inline Cell makeCell(Glyph g, Style st = Style()) {
+    return (Cell)g | kCellGlyph | ((Cell)st.pair << 16) | ((Cell)st.attrs << 24);
+}
+inline bool cellIsGlyph(Cell c) { return (c & kCellGlyph) != 0; }
+inline unsigned char cellChar(Cell c) { return (unsigned char)(c & 0xff); }
+inline Style cellStyle(Cell c) { return Style((c >> 16) & 0xff, (c >> 24) & 0xff); }
+
+class Surface {
+public:
+    virtual ~Surface() = default;
+
+    virtual int height() const = 0;
+    virtual int width() const = 0;
+
+    // Blank every cell
+    virtual void erase() = 0;
+    virtual void put(int y, int x, Cell c) = 0;
+    // Write n characters at (y, x), clipped at the right edge. Returns the
+    // column after the text, so a differently styled value can follow it.
+    virtual int text(int y, int x, const char* s, size_t n, Style st) = 0;
+    // Hand this frame's changes to the output (wnoutrefresh for ncurses)
+    virtual void stage() {}
+
+    int print(int y, int x, Style st, const char* fmt, ...) __attribute__((format(printf, 5, 6)));
+    int print(int y, int x, const char* s) { return print(y, x, Style(), "%s", s); }
+    void box(int y, int x, int h, int w, Style st = Style());
+    // Border around the whole surface with a title in the header style
+    void frame(const char* title);
+};
+
+// Draws into an ncurses WINDOW (passed as void*, like the windows in monitor.h)
+class NcursesSurface : public Surface {
+public:
+    explicit NcursesSurface(void* win) : win(win) {}
+
+    int height() const override;
+    int width() const override;
+    void erase() override;
+    void put(int y, int x, Cell c) override;
+    int text(int y, int x, const char* s, size_t n, Style st) override;
+    void stage() override;
+
+private:
+    void* win;
+};
+
+// In-memory grid: the headless backend
+class GridSurface : public Surface {
+public:
+    GridSurface(int height = 0, int width = 0) { resize(height, width); }
+
+    void resize(int height, int width);
+    int height() const override { return h; }
+    int width() const override { return w; }
+    void erase() override;
+    void put(int y, int x, Cell c) override;
+    int text(int y, int x, const char* s, size_t n, Style st) override;
+
+    Cell at(int y, int x) const { return cells[(size_t)y * w + x]; }
+    // Row y as plain text, glyphs replaced by ASCII stand-ins
+    std::string row(int y) const;
+
+private:
+    int h = 0;
+    int w = 0;
+    std::vector<Cell> cells;
+};
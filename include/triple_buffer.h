@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+
+// Single-producer/single-consumer handoff of the latest value. The writer
+// fills writeBuffer() and publish()es it; the reader's read() returns the
+// most recent complete value. Neither side ever blocks or waits for the
+// other: each owns one slot, and the third is swapped in and out with a
+// single atomic exchange. Intermediate values the reader never asked for
+// are simply overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& writeBuffer() { return slots[back]; }
+    void publish() {
+        unsigned prev = middle.exchange(back | kFresh, std::memory_order_acq_rel);
+        back = prev & kIndexMask;
+    }
+
+    // Reader side. The returned reference stays valid (and unchanged) until
+    // the next read().
+    const T& read() {
+        if (middle.load(std::memory_order_relaxed) & kFresh) {
+            unsigned prev = middle.exchange(front, std::memory_order_acq_rel);
+            front = prev & kIndexMask;
+        }
+        return slots[front];
+    }
+
+    // True if a value newer than the last read() is waiting
+    bool fresh() const { return (middle.load(std::memory_order_acquire) & kFresh) != 0; }
+
+private:
+    static constexpr unsigned kIndexMask = 3;
+    static constexpr unsigned kFresh = 4;
+
+    T slots[3];
+    std::atomic<unsigned> middle{1};
+    unsigned back = 0;  // writer-owned slot
+    unsigned front = 2; // reader-owned slot
+};
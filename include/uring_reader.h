@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Minimal io_uring wrapper (raw syscalls, no liburing) for submitting
+// batches of IORING_OP_READ on already-open fds and reaping them in bulk.
+// init() fails cleanly when the kernel lacks io_uring or it is blocked
+// (ENOSYS, EPERM from seccomp, kernel.io_uring_disabled), so callers can
+// fall back to plain pread.
+class UringReader {
+public:
+    UringReader() = default;
+    ~UringReader();
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    // Set up a ring with room for `entries` in-flight reads. Returns false
+    // (and leaves errno set) if io_uring cannot be used.
+    bool init(unsigned entries);
+    void shutdown();
+    bool ready() const { return ring_fd >= 0; }
+    unsigned capacity() const { return sq_entries; }
+
+    // Queue a read of up to len bytes at offset 0. Returns false when the
+    // submission queue is full; submit first.
+    bool queueRead(int fd, char* buf, unsigned len, uint64_t user_data);
+
+    // Submit everything queued and wait for all of it to complete, calling
+    // on_complete(ctx, user_data, res) per completion (res is bytes read or
+    // -errno). Returns the number of completions or -1 on error.
+    using CompletionFn = void (*)(void* ctx, uint64_t user_data, int res);
+    int submitAndWait(CompletionFn on_complete, void* ctx);
+
+    // io_uring_enter calls made so far
+    unsigned long enterCalls() const { return enter_calls; }
+
+private:
+    int ring_fd = -1;
+    unsigned sq_entries = 0;
+    unsigned queued = 0;
+
+    void* sq_ptr = nullptr;
+    size_t sq_len = 0;
+    void* cq_ptr = nullptr;
+    size_t cq_len = 0;
+    void* sqes_ptr = nullptr;
+    size_t sqes_len = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    void* cqes = nullptr;
+
+    unsigned long enter_calls = 0;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed-size pool for fork/join work. run() hands shard i to thread
+// i (the calling thread takes shard 0) and returns once every shard is
+// done, so each shard can write to its own preallocated output without
+// locking.
+class WorkerPool {
+public:
+    WorkerPool() = default;
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Total number of threads that take part in run(), including the caller
+    void resize(size_t threads);
+    size_t size() const { return workers.size() + 1; }
+
+    // Run fn(shard) for every shard in [0, min(shards, size())) and wait
+    void run(size_t shards, const std::function<void(size_t)>& fn);
+
+private:
+    void workerLoop(size_t id, uint64_t seen);
+    void stopAll();
+
+    std::vector<std::thread> workers;
+    std::mutex mu;
+    std::condition_variable cv_start;
+    std::condition_variable cv_done;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t job_shards = 0;
+    uint64_t job_generation = 0;
+    size_t pending = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,66 @@
+#include "../include/block_devices.h"
+#include "../include/procfs.h"
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+// Read a sysfs "dev" file ("8:1")
+static bool readDevNumber(const std::string& path, unsigned& major, unsigned& minor) {
+    char buf[32];
+    if (readProcFile(path.c_str(), buf, sizeof(buf)) <= 0) return false;
+    return sscanf(buf, "%u:%u", &major, &minor) == 2;
+}
+
+static bool dirHasEntries(const std::string& path) {
+    DIR* d = opendir(path.c_str());
+    if (!d) return false;
+    bool any = false;
+    while (struct dirent* e = readdir(d)) {
+        if (e->d_name[0] != '.') { any = true; break; }
+    }
+    closedir(d);
+    return any;
+}
+
+void BlockDeviceTable::scan() {
+    std::unordered_map<std::string, BlockDevice> old;
+    for (BlockDevice& d : devices) old[d.name] = std::move(d);
+    devices.clear();
+    by_dev.clear();
+
+    DIR* sys_block = opendir("/sys/block");
+    if (!sys_block) return;
+    while (struct dirent* e = readdir(sys_block)) {
+        if (e->d_name[0] == '.') continue;
+        std::string base = std::string("/sys/block/") + e->d_name + "/";
+        BlockDevice d;
+        if (!readDevNumber(base + "dev", d.major, d.minor)) continue;
+        d.name = e->d_name;
+        d.member = dirHasEntries(base + "holders");
+        d.loop = (access((base + "loop").c_str(), F_OK) == 0);
+        auto it = old.find(d.name);
+        if (it != old.end() && it->second.major == d.major && it->second.minor == d.minor) {
+            d.last = it->second.last;
+            d.sampled = it->second.sampled;
+        }
+
+        int index = (int)devices.size();
+        by_dev[devKey(d.major, d.minor)] = index;
+        DIR* disk_dir = opendir(base.c_str());
+        if (disk_dir) {
+            while (struct dirent* p = readdir(disk_dir)) {
+                if (strncmp(p->d_name, e->d_name, d.name.size()) != 0) continue;
+                std::string part = base + p->d_name + "/";
+                unsigned major, minor;
+                if (access((part + "partition").c_str(), F_OK) != 0 || !readDevNumber(part + "dev", major, minor))
+                    continue;
+                by_dev[devKey(major, minor)] = index;
+                if (dirHasEntries(part + "holders")) d.member = true; // e.g. sda1 in md0
+            }
+            closedir(disk_dir);
+        }
+        devices.push_back(std::move(d));
+    }
+    closedir(sys_block);
+}
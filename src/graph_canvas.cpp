@@ -0,0 +1,37 @@
+#include "../include/graph_canvas.h"
+#include <algorithm>
+#include <cstring>
+
+void GraphCanvas::resize(int width, int height) {
+    width = std::max(0, width);
+    height = std::max(0, height);
+    if (width == w && height == h) return;
+    w = width;
+    h = height;
+    cells.assign((size_t)w * h, makeCell(' '));
+    shown.assign((size_t)w * h, makeCell(' '));
+    shown_valid = false;
+}
+
+void GraphCanvas::clear() {
+    std::fill(cells.begin(), cells.end(), makeCell(' '));
+}
+
+void GraphCanvas::plot(int x, int row, Cell cell) {
+    if (x < 0 || x >= w || row < 0 || row >= h) return;
+    cells[(size_t)x * h + row] = cell;
+}
+
+int GraphCanvas::flush(Surface& out, int y, int x) {
+    int written = 0;
+    for (int cx = 0; cx < w; ++cx) {
+        const Cell* col = &cells[(size_t)cx * h];
+        Cell* prev = &shown[(size_t)cx * h];
+        if (shown_valid && memcmp(col, prev, sizeof(Cell) * h) == 0) continue;
+        for (int r = 0; r < h; ++r) out.put(y + r, x + cx, col[r]);
+        memcpy(prev, col, sizeof(Cell) * h);
+        ++written;
+    }
+    shown_valid = true;
+    return written;
+}
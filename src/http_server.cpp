@@ -0,0 +1,287 @@
+#include "../include/http_server.h"
+#include "../include/self_stats.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <strings.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const size_t kMaxRequest = 8 * 1024;
+static const size_t kMaxClients = 64;
+static const uint64_t kIdleNs = 10ULL * 1000000000ULL;
+
+HttpServer::~HttpServer() {
+    for (Client& c : clients) ::close(c.fd);
+    if (listen_fd >= 0) ::close(listen_fd);
+    if (!unix_path.empty()) unlink(unix_path.c_str());
+}
+
+static bool fail(std::string& error, const std::string& what, int fd = -1) {
+    error = what + ": " + strerror(errno);
+    if (fd >= 0) ::close(fd);
+    return false;
+}
+
+bool HttpServer::listen(const std::string& addr, std::string& error) {
+    if (addr.compare(0, 5, "unix:") == 0) {
+        std::string path = addr.substr(5);
+        struct sockaddr_un sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(sa.sun_path)) {
+            error = "bad socket path";
+            return false;
+        }
+        memcpy(sa.sun_path, path.c_str(), path.size() + 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return fail(error, "socket");
+        if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0) {
+            if (errno != EADDRINUSE) return fail(error, "bind " + path, fd);
+            // in use: by a running server, or left behind by one that died
+            int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            bool live = probe >= 0 && connect(probe, (struct sockaddr*)&sa, sizeof(sa)) == 0;
+            if (probe >= 0) ::close(probe);
+            errno = EADDRINUSE;
+            if (live) return fail(error, "bind " + path, fd);
+            unlink(path.c_str());
+            if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0) return fail(error, "bind " + path, fd);
+        }
+        if (::listen(fd, 16) < 0) return fail(error, "listen", fd);
+        listen_fd = fd;
+        unix_path = path;
+        bound = addr;
+        return true;
+    }
+
+    // "9100", "host:9100" or "[v6]:9100"
+    std::string host = "127.0.0.1", port = addr;
+    if (!addr.empty() && addr[0] == '[') {
+        size_t close = addr.find("]:");
+        if (close == std::string::npos) {
+            error = "expected [ADDRESS]:PORT";
+            return false;
+        }
+        host = addr.substr(1, close - 1);
+        port = addr.substr(close + 2);
+    } else if (addr.find(':') != std::string::npos) {
+        size_t colon = addr.rfind(':');
+        host = addr.substr(0, colon);
+        port = addr.substr(colon + 1);
+    }
+    struct addrinfo hints, *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+    if (rc != 0) {
+        error = std::string(host + ":" + port + ": ") + gai_strerror(rc);
+        return false;
+    }
+    int fd = socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return fail(error, "socket");
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    bool ok = bind(fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) return fail(error, "bind " + host + ":" + port, fd);
+    if (::listen(fd, 16) < 0) return fail(error, "listen", fd);
+    listen_fd = fd;
+    bound = (host.find(':') != std::string::npos ? "[" + host + "]" : host) + ":" + port;
+    return true;
+}
+
+void HttpServer::pollFds(std::vector<struct pollfd>& fds) const {
+    fds.push_back({listen_fd, POLLIN, 0});
+    for (const Client& c : clients) {
+        // read nothing more while a response is unsent
+        short events = (c.sent < c.out.size()) ? POLLOUT : c.close_after ? 0 : POLLIN;
+        fds.push_back({c.fd, events, 0});
+    }
+}
+
+int HttpServer::timeoutMs() const {
+    if (clients.empty()) return -1;
+    uint64_t next = UINT64_MAX;
+    for (const Client& c : clients) next = std::min(next, c.idle_deadline_ns);
+    uint64_t now = monotonicNs();
+    return next <= now ? 0 : (int)((next - now + 999999) / 1000000);
+}
+
+void HttpServer::handle(const std::vector<struct pollfd>& fds, size_t first, const Route& route) {
+    uint64_t now = monotonicNs();
+    // clients from pollFds() are at fds[first + 1 ...]; walk them backwards
+    // so dropping one does not move the ones still to do
+    size_t polled = std::min(clients.size(), fds.size() - std::min(fds.size(), first + 1));
+    for (size_t k = polled; k-- > 0;) {
+        Client& c = clients[k];
+        short re = fds[first + 1 + k].revents;
+        bool ok = !(re & (POLLERR | POLLNVAL));
+        if (ok && (re & (POLLIN | POLLHUP))) {
+            char buf[4096];
+            for (;;) {
+                ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+                if (n > 0) {
+                    c.in.insert(c.in.end(), buf, buf + n);
+                    c.idle_deadline_ns = now + kIdleNs;
+                    if (c.in.size() > kMaxRequest) break;
+                    continue;
+                }
+                if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) ok = false;
+                if (n == 0 || errno != EINTR) break;
+            }
+            // answer what arrived even if the client already shut down its side
+            if (!serve(c, route)) ok = false;
+            else if (!ok && c.sent < c.out.size()) {
+                c.close_after = true;
+                ok = true;
+            }
+        }
+        if (ok && c.sent < c.out.size()) ok = flush(c);
+        // then the requests held back behind it, while responses go out whole
+        while (ok && !c.close_after && c.sent == c.out.size() && !c.in.empty()) {
+            size_t before = c.in.size();
+            if (!serve(c, route)) ok = false;
+            else if (c.in.size() == before) break; // only part of a request so far
+            else ok = flush(c);
+        }
+        if (ok && c.close_after && c.sent == c.out.size()) ok = false;
+        if (ok && now >= c.idle_deadline_ns) ok = false;
+        if (!ok) drop(k);
+    }
+    if (first < fds.size() && (fds[first].revents & POLLIN)) accept();
+}
+
+void HttpServer::accept() {
+    for (;;) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN, or a connection that died in the backlog
+        if (clients.size() >= kMaxClients) {
+            ::close(fd);
+            continue;
+        }
+        Client c;
+        c.fd = fd;
+        c.idle_deadline_ns = monotonicNs() + kIdleNs;
+        clients.push_back(std::move(c));
+    }
+}
+
+void HttpServer::drop(size_t index) {
+    ::close(clients[index].fd);
+    clients.erase(clients.begin() + (long)index);
+}
+
+// Case-insensitive search for a header line "name: value" in [p, end)
+static bool headerHas(const char* p, const char* end, const char* name, const char* value) {
+    size_t name_len = strlen(name), value_len = strlen(value);
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+        if ((size_t)(eol - p) > name_len && strncasecmp(p, name, name_len) == 0 && p[name_len] == ':') {
+            for (const char* v = p + name_len + 1; v + value_len <= eol; ++v)
+                if (strncasecmp(v, value, value_len) == 0) return true;
+        }
+        p = eol + 1;
+    }
+    return false;
+}
+
+bool HttpServer::serve(Client& c, const Route& route) {
+    static const char kEnd[] = "\r\n\r\n";
+    size_t done = 0;
+    bool held = false;
+    for (;;) {
+        // one response in flight: later requests wait in c.in until it is sent
+        if (c.sent < c.out.size()) {
+            held = true;
+            break;
+        }
+        const char* begin = c.in.data() + done;
+        const char* end = c.in.data() + c.in.size();
+        const char* stop = std::search(begin, end, kEnd, kEnd + 4);
+        if (stop == end) break;
+        done = (size_t)(stop + 4 - c.in.data());
+
+        // "GET /metrics?x HTTP/1.1"
+        const char* eol = static_cast<const char*>(memchr(begin, '\r', (size_t)(stop - begin + 1)));
+        const char* sp1 = static_cast<const char*>(memchr(begin, ' ', (size_t)(eol - begin)));
+        const char* sp2 = sp1 ? static_cast<const char*>(memchr(sp1 + 1, ' ', (size_t)(eol - sp1 - 1))) : nullptr;
+        if (!sp2 || (size_t)(eol - sp2 - 1) != 8 || memcmp(sp2 + 1, "HTTP/1.", 7) != 0) {
+            c.close_after = true;
+            respond(c, 400, "Bad Request", nullptr, false);
+            break;
+        }
+        bool http10 = sp2[8] == '0';
+        const char* headers = eol + 2;
+        if (http10 ? !headerHas(headers, stop, "Connection", "keep-alive")
+                   : headerHas(headers, stop, "Connection", "close"))
+            c.close_after = true;
+
+        size_t method_len = (size_t)(sp1 - begin);
+        bool get = method_len == 3 && memcmp(begin, "GET", 3) == 0;
+        bool head = method_len == 4 && memcmp(begin, "HEAD", 4) == 0;
+        if (!get && !head) {
+            c.close_after = true; // whatever body it sent is not read
+            respond(c, 405, "Method Not Allowed", nullptr, false);
+            break;
+        }
+        const char* path = sp1 + 1;
+        const char* query = static_cast<const char*>(memchr(path, '?', (size_t)(sp2 - path)));
+        const OutBuf* body = route(path, (size_t)((query ? query : sp2) - path));
+        if (body) respond(c, 200, "OK", body, head);
+        else respond(c, 404, "Not Found", nullptr, head);
+        if (c.close_after) break;
+    }
+    c.in.erase(c.in.begin(), c.in.begin() + (long)done);
+    if (!held && c.in.size() > kMaxRequest) {
+        c.in.clear();
+        c.close_after = true;
+        respond(c, 431, "Request Header Fields Too Large", nullptr, false);
+    }
+    return true;
+}
+
+void HttpServer::respond(Client& c, int status, const char* reason, const OutBuf* body, bool head) {
+    OutBuf hdr(256);
+    hdr.put("HTTP/1.1 ").putInt(status).put(' ').put(reason).put("\r\n");
+    hdr.put("Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n");
+    size_t body_len = body ? body->size() : strlen(reason) + 1;
+    hdr.put("Content-Length: ").putUnsigned(body_len).put("\r\n");
+    if (c.close_after) hdr.put("Connection: close\r\n");
+    hdr.put("\r\n");
+    if (c.sent == c.out.size()) {
+        c.out.clear();
+        c.sent = 0;
+    }
+    c.out.insert(c.out.end(), hdr.data(), hdr.data() + hdr.size());
+    if (head) return;
+    if (body) {
+        c.out.insert(c.out.end(), body->data(), body->data() + body->size());
+    } else {
+        c.out.insert(c.out.end(), reason, reason + strlen(reason));
+        c.out.push_back('\n');
+    }
+}
+
+bool HttpServer::flush(Client& c) {
+    while (c.sent < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            c.sent += (size_t)n;
+            c.idle_deadline_ns = monotonicNs() + kIdleNs;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    c.out.clear();
+    c.sent = 0;
+    return true;
+}
@@ -1,5 +1,7 @@
 #include "../include/monitor.h"
+#include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 #include <getopt.h>
 
 void printUsage(const char* programName) {
@@ -12,6 +14,33 @@ void printUsage(const char* programName) {
               << "  -n, --no-notify          Disable system desktop notifications\n"
               << "  -d, --debug              Enable debug output\n"
               << "  -o, --debug-only         Run in debug-only mode (no UI)\n"
+              << "      --fd-cache[=MAX]     Keep /proc/<pid>/stat open between refreshes\n"
+              << "                           (MAX caps cached fds; default from RLIMIT_NOFILE)\n"
+              << "      --scan-threads=N     Worker threads for the /proc scan (default: CPUs/16, max 8)\n"
+              << "      --io-backend=NAME    /proc read backend: auto, pread or uring (default: auto)\n"
+              << "      --history-budget=KB  Memory for 1s/10s/1m/10m graph history (default: 1024)\n"
+              << "      --period=NAME=MS     Period of one collector: cpu, memory, disks, diskio,\n"
+              << "                           processes, temps, system, pressure or net (0 = refresh rate;\n"
+              << "                           defaults: disks=10000, temps=2000, others 0)\n"
+              << "      --statvfs-timeout=MS Wait this long for statvfs before showing a mount\n"
+              << "                           as stalled (default: 200)\n"
+              << "      --psi-trigger=RES:some|full:STALL_MS[:WINDOW_MS]\n"
+              << "                           Alert as soon as tasks stall on RES (cpu, memory, io)\n"
+              << "                           for STALL_MS within WINDOW_MS (default 1000);\n"
+              << "                           repeatable, e.g. memory:some:150:1000\n"
+              << "      --serve=ADDR         Serve Prometheus metrics at /metrics instead of running\n"
+              << "                           the UI; ADDR is a port (on 127.0.0.1), HOST:PORT or\n"
+              << "                           unix:PATH\n"
+              << "      --top=N              Processes included in exported metrics (default: 10)\n"
+              << "      --json               Print one JSON object per sample to stdout instead of\n"
+              << "                           running the UI\n"
+              << "      --count=N            With --json, stop after N samples (default: run until killed)\n"
+              << "      --interval=MS        Time between samples (same as --refresh-rate)\n"
+              << "      --record=FILE        Write every sample to FILE (compact binary log)\n"
+              << "      --replay=FILE        Show a recording instead of this system; [ and ] jump\n"
+              << "                           between keyframes, space pauses\n"
+              << "      --speed=N|max        Replay at N times the recorded pace (default: 1)\n"
+              << "      --overhead-summary   Print the monitor's own timings and resource use on exit\n"
               << "  -h, --help               Display help and exit\n"
               << std::endl;
 }
@@ -27,22 +56,107 @@ int main(int argc, char* argv[]) {
         {"debug",        no_argument,       0, 'd'},
         {"debug-only",   no_argument,       0, 'o'},
         {"help",         no_argument,       0, 'h'},
+        {"fd-cache",     optional_argument, 0, 'F'},
+        {"scan-threads", required_argument, 0, 'S'},
+        {"io-backend",   required_argument, 0, 'B'},
+        {"history-budget", required_argument, 0, 'H'},
+        {"overhead-summary", no_argument,   0, 'O'},
+        {"period",       required_argument, 0, 'P'},
+        {"statvfs-timeout", required_argument, 0, 'V'},
+        {"psi-trigger",  required_argument, 0, 'T'},
+        {"serve",        required_argument, 0, 'E'},
+        {"top",          required_argument, 0, 'N'},
+        {"json",         no_argument,       0, 'J'},
+        {"count",        required_argument, 0, 'C'},
+        {"interval",     required_argument, 0, 'r'},
+        {"record",       required_argument, 0, 'R'},
+        {"replay",       required_argument, 0, 'L'},
+        {"speed",        required_argument, 0, 'X'},
         {0, 0, 0, 0}
     };
 
     int opt;
     int option_index = 0;
-    while ((opt = getopt_long(argc, argv, "r:t:andoh", long_options, &option_index)) != -1) {
-        switch (opt) {
-            case 'r': config.refresh_rate_ms = std::stoi(optarg); break;
-            case 't': config.cpu_threshold = std::stof(optarg); break;
-            case 'a': config.show_alert = false; break;
-            case 'n': config.system_notifications = false; break;
-            case 'd': config.debug_mode = true; break;
-            case 'o': config.debug_mode = true; config.debug_only_mode = true; break;
-            case 'h': printUsage(argv[0]); return 0;
-            default: printUsage(argv[0]); return 1;
+    // numeric arguments go through std::stoi/stof, which throw on junk
+    try {
+        while ((opt = getopt_long(argc, argv, "r:t:andoh", long_options, &option_index)) != -1) {
+            switch (opt) {
+                case 'r': config.refresh_rate_ms = std::stoi(optarg); break;
+                case 't': config.cpu_threshold = std::stof(optarg); break;
+                case 'a': config.show_alert = false; break;
+                case 'n': config.system_notifications = false; break;
+                case 'd': config.debug_mode = true; break;
+                case 'o': config.debug_mode = true; config.debug_only_mode = true; break;
+                case 'F':
+                    config.proc_fd_cache = true;
+                    if (optarg) config.proc_fd_cache_max = std::stoi(optarg);
+                    break;
+                case 'S': config.scan_threads = std::stoi(optarg); break;
+                case 'B':
+                    config.io_backend = optarg;
+                    if (config.io_backend != "auto" && config.io_backend != "pread" && config.io_backend != "uring") {
+                        std::cerr << "Unknown I/O backend: " << optarg << "\n";
+                        return 1;
+                    }
+                    break;
+                case 'H': config.history_budget_kb = std::stoi(optarg); break;
+                case 'O': config.overhead_summary = true; break;
+                case 'V': config.statvfs_timeout_ms = std::stoi(optarg); break;
+                case 'T': {
+                    PsiTriggerSpec spec;
+                    if (!parsePsiTriggerSpec(optarg, spec)) {
+                        std::cerr << "Bad --psi-trigger (expected RES:some|full:STALL_MS[:WINDOW_MS]): " << optarg << "\n";
+                        return 1;
+                    }
+                    config.psi_triggers.push_back(spec);
+                    break;
+                }
+                case 'E': config.serve_addr = optarg; break;
+                case 'N': config.top_processes = std::stoi(optarg); break;
+                case 'J': config.json_mode = true; break;
+                case 'C': config.json_count = std::stoi(optarg); break;
+                case 'R': config.record_path = optarg; break;
+                case 'L': config.replay_path = optarg; break;
+                case 'X': {
+                    bool max = std::string(optarg) == "max";
+                    char* end = optarg;
+                    config.replay_speed = max ? 0.0 : std::strtod(optarg, &end);
+                    if (!max && (*end || !(config.replay_speed > 0 && config.replay_speed <= 1e6))) {
+                        std::cerr << "Bad --speed (expected a positive number or max): " << optarg << "\n";
+                        return 1;
+                    }
+                    break;
+                }
+                case 'P': {
+                    std::string arg = optarg;
+                    size_t eq = arg.find('=');
+                    int* period = (eq == std::string::npos) ? nullptr : config.periodFor(arg.substr(0, eq));
+                    if (!period) {
+                        std::cerr << "Bad --period (expected NAME=MS): " << optarg << "\n";
+                        return 1;
+                    }
+                    *period = std::stoi(arg.substr(eq + 1));
+                    break;
+                }
+                case 'h': printUsage(argv[0]); return 0;
+                default: printUsage(argv[0]); return 1;
+            }
         }
+    } catch (const std::logic_error&) { // invalid_argument, out_of_range
+        std::cerr << "Bad number: " << optarg << "\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (config.json_mode && !config.serve_addr.empty()) {
+        std::cerr << "--json and --serve are separate modes; use one of them\n";
+        return 1;
+    }
+
+    if (!config.replay_path.empty() &&
+        (!config.record_path.empty() || config.json_mode || !config.serve_addr.empty() || config.debug_only_mode)) {
+        std::cerr << "--replay only drives the UI; it cannot be combined with --record, --json, --serve or -o\n";
+        return 1;
     }
 
     try {
@@ -51,6 +165,10 @@ int main(int argc, char* argv[]) {
 
         if (config.debug_only_mode) {
             monitor.runDebugMode();
+        } else if (config.json_mode) {
+            monitor.runJson();
+        } else if (!config.serve_addr.empty()) {
+            monitor.runServe();
         } else {
             monitor.run();
         }
@@ -1,4 +1,6 @@
 #include "../include/monitor.h"
+#include "../include/procfs.h"
+#include "../include/recording.h"
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -11,69 +13,551 @@
 #include <thread>
 #include <unistd.h>
 #include <iomanip>
+#include <cstring>
+#include <cstdlib>
 #include <ncurses.h>
 // thread/chrono used for timed waits in killProcess
 #include <thread>
 #include <chrono>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 
-ActivityMonitor::ActivityMonitor() {
+// Timestamp for rollup buckets
+static uint64_t steadyMs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ActivityMonitor::ActivityMonitor()
+    : total_history(history_length), mem_history(history_length), swap_history(history_length),
+      majflt_history(history_length), swapio_history(history_length), refault_history(history_length),
+      diskio_read_history(history_length), diskio_write_history(history_length) {
+    // SIGWINCH is consumed through a signalfd in run(). Block it here, before
+    // any worker or collector thread exists, so every thread inherits the mask
+    // and the signal stays pending for the fd instead of hitting a handler.
+    sigset_t winch;
+    sigemptyset(&winch);
+    sigaddset(&winch, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &winch, nullptr);
     last_update = std::chrono::high_resolution_clock::now();
+    long page_size = sysconf(_SC_PAGESIZE);
+    page_size_kb = (page_size > 0) ? (unsigned long)page_size / 1024 : 4;
 }
 
 ActivityMonitor::~ActivityMonitor() {
+    stopCollector();
     if (debug_file.is_open()) debug_file.close();
 }
 
 void ActivityMonitor::setConfig(const MonitorConfig& cfg) {
     config = cfg;
+    if (!config.serve_addr.empty()) {
+        // runServe() takes SIGINT/SIGTERM through a signalfd; block them
+        // before the scan workers and statvfs helpers below are started
+        sigset_t stop;
+        sigemptyset(&stop);
+        sigaddset(&stop, SIGINT);
+        sigaddset(&stop, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &stop, nullptr);
+    }
+    proc_scanner.setThreads(config.scan_threads);
+    proc_scanner.setFdCache(config.proc_fd_cache, (size_t)std::max(0, config.proc_fd_cache_max));
+    ScanBackend backend = ScanBackend::Auto;
+    if (config.io_backend == "pread") backend = ScanBackend::Pread;
+    else if (config.io_backend == "uring") backend = ScanBackend::Uring;
+    proc_scanner.setBackend(backend);
+    if (backend == ScanBackend::Uring && proc_scanner.backend() != ScanBackend::Uring && config.debug_mode)
+        debugLog("io_uring unavailable, using pread for /proc scans");
+    size_t buckets = RollupHistory::bucketsForBudget((size_t)std::max(0, config.history_budget_kb) * 1024, kRollupSeries);
+    for (RollupHistory* r : {&total_rollup, &mem_rollup, &swap_rollup, &majflt_rollup, &swapio_rollup,
+                             &refault_rollup, &diskio_read_rollup, &diskio_write_rollup})
+        r->reset(buckets);
+    if (config.debug_mode) {
+        // how far back each tier reaches follows from the budget and the series count
+        std::string spans;
+        for (int t = 0; t < RollupHistory::kTiers; ++t) {
+            char span[48];
+            snprintf(span, sizeof(span), " %s=%.1fh", RollupHistory::tierName(t),
+                     (double)buckets * RollupHistory::kPeriodMs[t] / 3.6e6);
+            spans += span;
+        }
+        debugLog("Rollup history: " + std::to_string(buckets) + " buckets per tier for " +
+                 std::to_string(kRollupSeries) + " series," + spans);
+    }
+    // one ring per possible CPU up front: published spans point into these,
+    // so they must not be reallocated once the collector thread runs
+    long conf_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    cpu_history.clear();
+    cpu_history.resize((size_t)std::max(1L, conf_cpus));
+    for (auto& h : cpu_history) h.reset(history_length);
+    for (auto& h : psi_some_history) h.reset(history_length);
+    for (int i = 0; i < kNetHistorySlots; ++i) {
+        net_rx_history[i].reset(history_length);
+        net_tx_history[i].reset(history_length);
+    }
+    if (!config.replay_path.empty()) {
+        openReplay(); // publishes the first recorded frame instead
+        return;
+    }
+    if (!config.record_path.empty()) {
+        std::string error;
+        recorder.reset(new RecordWriter);
+        if (!recorder->open(config.record_path, error)) throw std::runtime_error("Cannot record to " + error);
+    }
     // initialize first snapshot
+    readSystemStat();
     updateCPUInfo();
     updateMemoryInfo();
     updateDiskInfo();
     updateProcessInfo();
-    updateMemoryStats();
-    updateDiskLatency();
+    updateVmStat();
     updateDiskIOInfo();   // Initialize disk I/O baseline
     updateSystemInfo();   // Initialize system info
+    updatePressure();
+    updateNetInfo();
+    sampleSelfUsage();    // baseline for the per-tick overhead figures
+    publishSnapshot(!config.json_mode); // --json never prints this one
 
     if (config.debug_mode) debugLog("Configuration set");
 }
 
-void ActivityMonitor::collectData() {
-    updateCPUInfo();
-    updateMemoryInfo();
-    updateDiskInfo();
-    updateProcessInfo();
-    updateMemoryStats();
-    updateDiskLatency();
-    updateDiskIOInfo();
-    updateTempInfo();
-    updateSystemInfo();
+const char* collectorName(int collector) {
+    static const char* const names[CollectorCount] = {
+        "stat", "cpu", "memory", "disks", "processes",
+        "vmstat", "diskio", "temps", "system", "pressure", "net"};
+    return (collector >= 0 && collector < CollectorCount) ? names[collector] : "?";
 }
 
-// Very simple CPU reader: reads /proc/stat and computes usage since last call
-void ActivityMonitor::updateCPUInfo() {
-    std::ifstream f("/proc/stat");
-    if (!f) throw std::runtime_error("Failed to open /proc/stat");
+static uint32_t bit(int collector) { return 1u << collector; }
 
-    std::string line;
-    std::vector<unsigned long long> totals;
-    std::vector<float> core_percentages;
-    std::vector<unsigned long long> idles; // idle + iowait per line (cpu, cpu0, ...)
+// Independently scheduled collector groups: the config field holding the
+// period and the collectors each group runs
+static const struct {
+    const char* name;
+    int MonitorConfig::*period_ms;
+    uint32_t collectors;
+} kSchedule[] = {
+    {"cpu", &MonitorConfig::cpu_period_ms, bit(CollectCPU)},
+    {"memory", &MonitorConfig::memory_period_ms, bit(CollectMemory) | bit(CollectVmStat)},
+    {"disks", &MonitorConfig::disks_period_ms, bit(CollectDisks)},
+    {"diskio", &MonitorConfig::diskio_period_ms, bit(CollectDiskIO)},
+    {"processes", &MonitorConfig::processes_period_ms, bit(CollectProcesses)},
+    {"temps", &MonitorConfig::temps_period_ms, bit(CollectTemps)},
+    {"system", &MonitorConfig::system_period_ms, bit(CollectSystem)},
+    {"pressure", &MonitorConfig::pressure_period_ms, bit(CollectPressure)},
+    {"net", &MonitorConfig::net_period_ms, bit(CollectNet)},
+};
+static const int kScheduleGroups = sizeof(kSchedule) / sizeof(kSchedule[0]);
 
-    while (std::getline(f, line)) {
-        if (line.rfind("cpu", 0) != 0) break;
-        std::istringstream iss(line);
-        std::string cpu_label;
-        iss >> cpu_label;
-    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
-        user = nice = system = idle = iowait = irq = softirq = steal = 0;
-        iss >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-        unsigned long long total = user + nice + system + idle + iowait + irq + softirq + steal;
-        totals.push_back(total);
-    // store idle (idle + iowait) for accurate busy% later
-    idles.push_back(idle + iowait);
+int* MonitorConfig::periodFor(const std::string& name) {
+    for (const auto& g : kSchedule)
+        if (name == g.name) return &(this->*g.period_ms);
+    return nullptr;
+}
+
+void ActivityMonitor::collectData(uint32_t collectors) {
+    // the CPU and system collectors share one read of /proc/stat
+    if (collectors & (bit(CollectCPU) | bit(CollectSystem))) collectors |= bit(CollectStat);
+
+    static void (ActivityMonitor::*const update[CollectorCount])() = {
+        &ActivityMonitor::readSystemStat, &ActivityMonitor::updateCPUInfo,
+        &ActivityMonitor::updateMemoryInfo, &ActivityMonitor::updateDiskInfo,
+        &ActivityMonitor::updateProcessInfo, &ActivityMonitor::updateVmStat,
+        &ActivityMonitor::updateDiskIOInfo, &ActivityMonitor::updateTempInfo,
+        &ActivityMonitor::updateSystemInfo, &ActivityMonitor::updatePressure,
+        &ActivityMonitor::updateNetInfo};
+    uint64_t t0 = monotonicNs();
+    for (int c = 0; c < CollectorCount; ++c)
+        if (collectors & bit(c)) timeCollector(c, update[c]);
+    tick_hist.add(monotonicNs() - t0);
+    sampleSelfUsage();
+}
+
+int ActivityMonitor::groupPeriodMs(int group) const {
+    int ms = config.*kSchedule[group].period_ms;
+    return std::max(1, ms > 0 ? ms : config.refresh_rate_ms);
+}
+
+uint32_t ActivityMonitor::dueCollectors(uint64_t now_ns) {
+    uint32_t due = 0;
+    while (!schedule.empty() && schedule.top().deadline_ns <= now_ns) {
+        ScheduledCollector next = schedule.top();
+        schedule.pop();
+        due |= kSchedule[next.group].collectors;
+        // stay on the group's own grid; deadlines we slept through are
+        // dropped, not run back to back
+        uint64_t period_ns = (uint64_t)groupPeriodMs(next.group) * 1000000ULL;
+        next.deadline_ns += period_ns;
+        if (next.deadline_ns <= now_ns) {
+            uint64_t missed = (now_ns - next.deadline_ns) / period_ns + 1;
+            next.deadline_ns += missed * period_ns;
+            if (config.debug_mode)
+                debugLog(std::string("Collector ") + kSchedule[next.group].name + " missed " + std::to_string(missed) + " deadline(s)");
+        }
+        schedule.push(next);
+    }
+    return due;
+}
+
+// Seconds since this collector's previous sample (0 for the first one);
+// now_ns becomes the previous sample
+double ActivityMonitor::sampleInterval(int collector, uint64_t now_ns) {
+    uint64_t prev = sample_ns[collector];
+    sample_ns[collector] = now_ns;
+    return (prev && now_ns > prev) ? (now_ns - prev) / 1e9 : 0.0;
+}
+
+void ActivityMonitor::timeCollector(int collector, void (ActivityMonitor::*update)()) {
+    uint64_t t0 = monotonicNs();
+    (this->*update)();
+    collector_hist[collector].add(monotonicNs() - t0);
+}
+
+// Our own CPU time, faults and syscalls since the previous tick
+void ActivityMonitor::sampleSelfUsage() {
+    SelfUsage now;
+    if (!readSelfUsage(now)) return;
+    uint64_t now_ns = monotonicNs();
+    if (self_prev_ns) {
+        static const long ticks_per_sec = sysconf(_SC_CLK_TCK);
+        uint64_t wall_ns = now_ns - self_prev_ns;
+        uint64_t cpu_ns = (now.cpu_ticks - self_prev.cpu_ticks) * 1000000000ULL / (ticks_per_sec > 0 ? ticks_per_sec : 100);
+        if (wall_ns) self_cpu_hist.add(cpu_ns * 10000 / wall_ns);
+        self_fault_hist.add(now.minor_faults - self_prev.minor_faults);
+        self_syscall_hist.add(now.syscalls - self_prev.syscalls);
+    }
+    self_prev = now;
+    self_prev_ns = now_ns;
+}
+
+void ActivityMonitor::fillOverhead(OverheadStats& out) const {
+    for (int c = 0; c < CollectorCount; ++c) out.collector_ns[c] = collector_hist[c].summary();
+    out.tick_ns = tick_hist.summary();
+    out.cpu_pct_x100 = self_cpu_hist.summary();
+    out.minor_faults = self_fault_hist.summary();
+    out.syscalls = self_syscall_hist.summary();
+    out.usage = self_prev;
+    out.page_size_kb = page_size_kb;
+}
+
+// Change stamps over what each panel shows. A history span into a ring moves
+// (or grows) on every push, so hashing its position covers the graph; the
+// collector stamps before copying the histories out of the rings.
+void stampSnapshot(MonitorSnapshot& s) {
+    ChangeStamp cpu;
+    cpu.add(s.cpu.total_usage).add(s.cpu.num_cores)
+       .bytes(s.cpu.core_usage.data(), s.cpu.core_usage.size() * sizeof(float))
+       .add(s.total_history.ptr).add(s.total_history.len);
+    for (int t = 0; t < RollupHistory::kTiers; ++t)
+        cpu.add(s.total_rollup[t].closed.len).add(s.total_rollup[t].open);
+    s.cpu_stamp = cpu.h;
+
+    ChangeStamp mem;
+    mem.add(s.memory.percent_used).add(s.memory.swap_percent_used)
+       .add(s.memory.major_faults_per_sec).add(s.memory.minor_faults_per_sec)
+       .add(s.memory.pgscan_per_sec).add(s.memory.pgsteal_per_sec)
+       .add(s.memory.swap_in_per_sec).add(s.memory.swap_out_per_sec)
+       .add(s.memory.refaults_per_sec).add(s.memory.cache_effectiveness)
+       .add(s.mem_history.ptr).add(s.mem_history.len)
+       .add(s.majflt_history.ptr).add(s.majflt_history.len);
+    for (int t = 0; t < RollupHistory::kTiers; ++t)
+        mem.add(s.mem_rollup[t].closed.len).add(s.mem_rollup[t].open).add(s.swap_rollup[t].open)
+           .add(s.majflt_rollup[t].closed.len).add(s.majflt_rollup[t].open)
+           .add(s.swapio_rollup[t].open).add(s.refault_rollup[t].open);
+    s.memory_stamp = mem.h;
+
+    ChangeStamp sys;
+    sys.add((long long)s.system.uptime_seconds / 60)
+       .add(s.system.load_1min).add(s.system.load_5min).add(s.system.load_15min)
+       .add(s.system.ctx_switches_per_sec).add(s.system.interrupts_per_sec)
+       .add(s.system.forks_per_sec).add(s.system.procs_running).add(s.system.procs_blocked)
+       .add(s.pressure.available);
+    for (int r = 0; r < PsiResourceCount; ++r) {
+        const PsiResource& p = s.pressure.resource[r];
+        sys.add(p.some.avg10).add(p.some.avg60).add(p.full.avg10).add(p.full.avg60)
+           .add(s.psi_some_history[r].ptr).add(s.psi_some_history[r].len);
+    }
+    s.system_stamp = sys.h;
+
+    ChangeStamp disks;
+    for (const DiskInfo& d : s.disks)
+        disks.add(d.device).add(d.mount_point).add(d.used_space).add(d.free_space).add(d.percent_used).add(d.stalled);
+    s.disks_stamp = disks.h;
+
+    ChangeStamp io;
+    io.add(s.diskio.read_mb_per_sec).add(s.diskio.write_mb_per_sec)
+      .add(s.diskio.read_ops_per_sec).add(s.diskio.write_ops_per_sec)
+      .add(s.diskio.io_busy_percent);
+    for (const DiskDeviceIO& d : s.diskio.devices)
+        io.add(d.name).add(d.mount_point).add(d.read_mb_per_sec).add(d.write_mb_per_sec)
+          .add(d.await_ms).add(d.queue_depth).add(d.util_percent);
+    // the panel only uses its history for the bar scale, so hash the peak
+    float io_peak = 0.0f;
+    for (float v : s.diskio_read_history) io_peak = std::max(io_peak, v);
+    for (float v : s.diskio_write_history) io_peak = std::max(io_peak, v);
+    io.add(io_peak);
+    for (int t = 0; t < RollupHistory::kTiers; ++t)
+        io.add(s.diskio_read_rollup[t].closed.len).add(s.diskio_read_rollup[t].open).add(s.diskio_write_rollup[t].open);
+    s.diskio_stamp = io.h;
+
+    ChangeStamp net;
+    net.add(s.net.rx_mb_per_sec).add(s.net.tx_mb_per_sec).add(s.net.drops_per_sec).add(s.net.errors_per_sec);
+    for (const NetInterfaceIO& n : s.net.interfaces)
+        net.add(n.name).add(n.rx_mb_per_sec).add(n.tx_mb_per_sec)
+           .add(n.rx_packets_per_sec).add(n.tx_packets_per_sec)
+           .add(n.drops_per_sec).add(n.errors_per_sec).add(n.util_percent)
+           .add(n.rx_history.ptr).add(n.rx_history.len);
+    s.net_stamp = net.h;
+
+    ChangeStamp procs;
+    for (const Process& p : s.processes)
+        procs.add(p.pid).add(p.name).add(p.cpu_percent).add(p.mem_percent);
+    s.processes_stamp = procs.h;
+}
+
+// Every history span of a snapshot: raw(Span<float>&) and
+// rollup(Span<RollupBucket>&), in a fixed order
+template <class Raw, class Rollup>
+static void forEachHistory(MonitorSnapshot& s, Raw raw, Rollup rollup) {
+    for (Span<float>& h : s.cpu_history) raw(h);
+    for (Span<float>* h : {&s.total_history, &s.mem_history, &s.swap_history, &s.majflt_history, &s.swapio_history,
+                           &s.refault_history, &s.diskio_read_history, &s.diskio_write_history})
+        raw(*h);
+    for (Span<float>& h : s.psi_some_history) raw(h);
+    for (NetInterfaceIO& n : s.net.interfaces) {
+        raw(n.rx_history);
+        raw(n.tx_history);
     }
+    for (int t = 0; t < RollupHistory::kTiers; ++t)
+        for (RollupView* v : {&s.total_rollup[t], &s.mem_rollup[t], &s.swap_rollup[t], &s.majflt_rollup[t],
+                              &s.swapio_rollup[t], &s.refault_rollup[t], &s.diskio_read_rollup[t],
+                              &s.diskio_write_rollup[t]})
+            rollup(v->closed);
+}
+
+// Re-point the history spans of a snapshot from the rings into its own
+// stores, so later pushes cannot change what a reader of it sees
+static void copyHistories(MonitorSnapshot& s) {
+    const size_t kMax = MonitorSnapshot::kSnapshotRollupBuckets;
+    size_t floats = 0, buckets = 0;
+    forEachHistory(s, [&](Span<float>& h) { floats += h.len; },
+                   [&](Span<RollupBucket>& c) {
+                       if (c.len > kMax) {
+                           c.ptr += c.len - kMax; // the newest ones
+                           c.len = kMax;
+                       }
+                       buckets += c.len;
+                   });
+    s.history_store.resize(floats);
+    s.rollup_store.resize(buckets);
+    float* f = s.history_store.data();
+    RollupBucket* b = s.rollup_store.data();
+    forEachHistory(s,
+                   [&](Span<float>& h) {
+                       std::copy(h.begin(), h.end(), f);
+                       h.ptr = f;
+                       f += h.len;
+                   },
+                   [&](Span<RollupBucket>& c) {
+                       std::copy(c.begin(), c.end(), b);
+                       c.ptr = b;
+                       b += c.len;
+                   });
+}
+
+// Copy the collector state into the free snapshot slot and hand it to the
+// UI. The slot's vectors keep their capacity across ticks.
+void ActivityMonitor::publishSnapshot(bool record) {
+    MonitorSnapshot& s = snapshots.writeBuffer();
+    s.seq = ++snapshot_seq;
+    if (replay) {
+        s.wall_ms = replay_frame.wall_ms;
+    } else {
+        struct timespec wall;
+        clock_gettime(CLOCK_REALTIME, &wall);
+        s.wall_ms = (uint64_t)wall.tv_sec * 1000 + (uint64_t)wall.tv_nsec / 1000000;
+    }
+    s.cpu = cpu_info;
+    s.memory = memory_info;
+    s.system = system_info;
+    s.pressure = pressure_info;
+    s.diskio = diskio_info;
+    s.net = net_info;
+    s.disks = disk_info;
+    s.processes = processes;
+    s.temperatures = temperatures;
+    fillOverhead(s.overhead);
+
+    size_t cores = std::min(cpu_history.size(), (size_t)std::max(0, cpu_info.num_cores));
+    s.cpu_history.resize(cores);
+    for (size_t i = 0; i < cores; ++i) s.cpu_history[i] = cpu_history[i].span();
+    s.total_history = total_history.span();
+    s.mem_history = mem_history.span();
+    s.swap_history = swap_history.span();
+    s.majflt_history = majflt_history.span();
+    s.swapio_history = swapio_history.span();
+    s.refault_history = refault_history.span();
+    for (int r = 0; r < PsiResourceCount; ++r) s.psi_some_history[r] = psi_some_history[r].span();
+    s.diskio_read_history = diskio_read_history.span();
+    s.diskio_write_history = diskio_write_history.span();
+    // only the tier the graphs show; the others stay empty and uncopied
+    int tier = history_tier;
+    for (int t = 0; t < RollupHistory::kTiers; ++t) {
+        if (t != tier) {
+            for (RollupView* v : {&s.total_rollup[t], &s.mem_rollup[t], &s.swap_rollup[t], &s.majflt_rollup[t],
+                                  &s.swapio_rollup[t], &s.refault_rollup[t], &s.diskio_read_rollup[t],
+                                  &s.diskio_write_rollup[t]})
+                *v = RollupView();
+            continue;
+        }
+        s.total_rollup[t] = total_rollup.view(t);
+        s.mem_rollup[t] = mem_rollup.view(t);
+        s.swap_rollup[t] = swap_rollup.view(t);
+        s.majflt_rollup[t] = majflt_rollup.view(t);
+        s.swapio_rollup[t] = swapio_rollup.view(t);
+        s.refault_rollup[t] = refault_rollup.view(t);
+        s.diskio_read_rollup[t] = diskio_read_rollup.view(t);
+        s.diskio_write_rollup[t] = diskio_write_rollup.view(t);
+    }
+
+    // stamp while the spans still show their ring positions, then copy
+    stampSnapshot(s);
+    copyHistories(s);
+    if (record) {
+        if (recorder && !recorder->append(s, collected_mask, steadyMs())) {
+            debugLog(std::string("Recording stopped: ") + strerror(errno));
+            recorder.reset();
+        }
+        collected_mask = 0;
+    }
+    snapshots.publish();
+}
+
+void ActivityMonitor::requestRefresh() {
+    if (replay) {
+        // nothing to collect: publish the frame shown again, in the current sort order
+        sortProcesses();
+        publishSnapshot();
+        return;
+    }
+    if (collector_wake_fd < 0) return;
+    uint64_t one = 1;
+    ssize_t r = ::write(collector_wake_fd, &one, sizeof(one));
+    (void)r; // EAGAIN: a wakeup is already pending
+}
+
+// Collector thread: each collector group has its own period and the next
+// deadline of every group sits in a min-heap. The thread sleeps on a
+// timerfd armed (absolute) for the earliest deadline, runs just the groups
+// that are due, and publishes. An eventfd carries refresh requests from
+// the UI, which run every collector at once without moving the deadlines.
+// After each publish the UI is woken through its own eventfd. The UI
+// never waits on this thread.
+void ActivityMonitor::collectorLoop() {
+    // mountinfo signals POLLPRI when a filesystem is mounted or unmounted
+    struct pollfd fds[3] = {{timer_fd, POLLIN, 0}, {collector_wake_fd, POLLIN, 0},
+                            {mount_table.fd(), POLLPRI, 0}};
+    while (!collector_stop.load()) {
+        uint64_t deadline = schedule.top().deadline_ns;
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        its.it_value.tv_sec = (time_t)(deadline / 1000000000ULL);
+        its.it_value.tv_nsec = (long)(deadline % 1000000000ULL);
+        if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, nullptr) < 0) {
+            debugLog(std::string("Collector timer failed: ") + strerror(errno));
+            break;
+        }
+        if (::poll(fds, mount_table.fd() >= 0 ? 3 : 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            debugLog(std::string("Collector poll failed: ") + strerror(errno));
+            break;
+        }
+        uint64_t n = 0;
+        if (fds[0].revents & POLLIN) {
+            ssize_t r = ::read(timer_fd, &n, sizeof(n));
+            (void)r;
+        }
+        bool refresh = false;
+        if (fds[1].revents & POLLIN) {
+            ssize_t r = ::read(collector_wake_fd, &n, sizeof(n));
+            (void)r;
+            refresh = true;
+        }
+        if (collector_stop.load()) break;
+        uint32_t due = dueCollectors(monotonicNs());
+        if (refresh) due = kAllCollectors;
+        if (fds[2].revents & (POLLPRI | POLLERR)) {
+            // show the new mount now rather than at the next disks tick
+            mount_table.markChanged();
+            due |= bit(CollectDisks);
+        }
+        if (!due) continue;
+        try {
+            collectData(due);
+            publishSnapshot();
+        } catch (const std::exception& e) {
+            // keep the last snapshot on screen rather than killing the UI
+            debugLog(std::string("Collection failed: ") + e.what());
+            continue;
+        }
+        uint64_t one = 1;
+        ssize_t r = ::write(ui_wake_fd, &one, sizeof(one));
+        (void)r;
+    }
+}
+
+void ActivityMonitor::startCollector() {
+    if (collector.joinable()) return;
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timer_fd < 0) throw std::runtime_error("Failed to create timerfd");
+    collector_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ui_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (collector_wake_fd < 0 || ui_wake_fd < 0) throw std::runtime_error("Failed to create eventfd");
+
+    resetSchedule(monotonicNs());
+    collector_stop = false;
+    collector = std::thread(&ActivityMonitor::collectorLoop, this);
+}
+
+// Every group is first due one of its periods after now_ns
+void ActivityMonitor::resetSchedule(uint64_t now_ns) {
+    schedule = decltype(schedule)();
+    std::string periods;
+    for (int g = 0; g < kScheduleGroups; ++g) {
+        schedule.push({now_ns + (uint64_t)groupPeriodMs(g) * 1000000ULL, g});
+        periods += std::string(" ") + kSchedule[g].name + "=" + std::to_string(groupPeriodMs(g));
+    }
+    if (config.debug_mode) debugLog("Collector periods (ms):" + periods);
+}
+
+void ActivityMonitor::stopCollector() {
+    if (collector.joinable()) {
+        collector_stop = true;
+        requestRefresh();
+        collector.join();
+    }
+    for (int* fd : {&timer_fd, &collector_wake_fd, &ui_wake_fd}) {
+        if (*fd >= 0) ::close(*fd);
+        *fd = -1;
+    }
+}
+
+// Read /proc/stat once per tick into a reused buffer. updateCPUInfo and
+// updateSystemInfo both work from this one snapshot.
+void ActivityMonitor::readSystemStat() {
+    if (proc_stat_buf.empty()) proc_stat_buf.resize(16 * 1024);
+    // grows with the CPU and IRQ count
+    ssize_t n = readProcFileGrow("/proc/stat", proc_stat_buf);
+    if (n < 0) throw std::runtime_error("Failed to open /proc/stat");
+    parseSystemStat(proc_stat_buf.data(), (size_t)n, system_stat);
+    stat_read_ns = monotonicNs();
+}
+
+// Computes CPU usage from the /proc/stat snapshot since the last call
+void ActivityMonitor::updateCPUInfo() {
+    const std::vector<unsigned long long>& totals = system_stat.cpu_total;
+    const std::vector<unsigned long long>& idles = system_stat.cpu_idle; // idle + iowait per line (cpu, cpu0, ...)
 
     if (totals.empty()) return;
 
@@ -126,17 +610,7 @@ void ActivityMonitor::updateCPUInfo() {
     cpu_info.total_usage = 100.0f * (float)delta_busy_total / (float)total_diff;
     cpu_info.num_cores = cores;
 
-    // push into history buffers
-    if (total_history.size() >= history_length) total_history.erase(total_history.begin());
-    total_history.push_back(cpu_info.total_usage);
-
-    // ensure cpu_history has entries per core
-    if (cpu_history.size() != static_cast<size_t>(cpu_info.num_cores)) cpu_history.assign(cpu_info.num_cores, std::vector<float>());
-    for (int i = 0; i < cpu_info.num_cores; ++i) {
-        auto &h = cpu_history[i];
-        if (h.size() >= history_length) h.erase(h.begin());
-        h.push_back(cpu_info.core_usage[i]);
-    }
+    pushHistory(CollectCPU, steadyMs());
 
     if (config.debug_mode) debugLog("CPU updated: total=" + std::to_string(cpu_info.total_usage));
 }
@@ -175,231 +649,348 @@ void ActivityMonitor::updateMemoryInfo() {
 
     if (config.debug_mode) debugLog("Memory updated: " + std::to_string(memory_info.percent_used) + "%");
 
-    if (mem_history.size() >= history_length) mem_history.erase(mem_history.begin());
-    mem_history.push_back(memory_info.percent_used);
-    if (swap_history.size() >= history_length) swap_history.erase(swap_history.begin());
-    swap_history.push_back(memory_info.swap_percent_used);
+    pushHistory(CollectMemory, steadyMs());
 }
 
 void ActivityMonitor::updateDiskInfo() {
-    std::ifstream mounts("/proc/mounts");
-    if (!mounts) throw std::runtime_error("Failed to open /proc/mounts");
-    disk_info.clear();
-    std::string line;
-    while (std::getline(mounts, line)) {
-        std::istringstream iss(line);
-        std::string device, mount_point, fs_type, opts;
-        int dump, pass;
-        iss >> device >> mount_point >> fs_type >> opts >> dump >> pass;
-        // skip pseudo filesystems
-        if (fs_type=="proc" || fs_type=="sysfs" || fs_type=="tmpfs" || fs_type=="devtmpfs" ) continue;
+    // the mount list is only re-parsed after the kernel reports a change
+    if (mount_table.refresh() && config.debug_mode)
+        debugLog("Mount table reloaded: " + std::to_string(mount_table.mounts().size()) + " filesystems");
 
-        struct statvfs st;
-        if (statvfs(mount_point.c_str(), &st) != 0) continue;
+    // statvfs runs on helper threads; a mount that does not answer in time
+    // is shown stalled with its last good sizes
+    statvfs_prober.setTimeout(config.statvfs_timeout_ms);
+    statvfs_prober.refresh(mount_table.mountPoints());
+
+    disk_info.clear();
+    for (const MountEntry& m : mount_table.mounts()) {
+        const StatvfsProber::Entry* e = statvfs_prober.find(m.mount_point);
+        if (!e || (!e->valid && !e->stalled)) continue; // statvfs failed
 
         DiskInfo d;
-        d.device = device;
-        d.mount_point = mount_point;
-        unsigned long block_size = st.f_frsize;
-        d.total_space = (st.f_blocks * block_size) / 1024;
-        d.free_space = (st.f_bfree * block_size) / 1024;
+        d.device = m.source;
+        d.mount_point = m.mount_point;
+        d.stalled = e->stalled;
+        d.total_space = e->space.total_kb;
+        d.free_space = e->space.free_kb;
         d.used_space = (d.total_space > d.free_space) ? (d.total_space - d.free_space) : 0;
         d.percent_used = (d.total_space==0)?0.0f:(100.0f * d.used_space / d.total_space);
         disk_info.push_back(d);
+        if (e->stalled && config.debug_mode) debugLog("statvfs stalled: " + m.mount_point);
     }
 
     if (config.debug_mode) debugLog("Disk info updated: " + std::to_string(disk_info.size()) + " mounts");
 }
 
 void ActivityMonitor::updateProcessInfo() {
-    processes.clear();
-    DIR* pd = opendir("/proc");
-    if (!pd) throw std::runtime_error("Failed to open /proc");
-    struct dirent* ent;
-
-    // compute total diff for CPU jiffies
-    unsigned long long total_diff = 0;
-    if (curr_cpu_times.size() > 0 && prev_cpu_times.size() > 0) {
-        total_diff = (curr_cpu_times[0] > prev_cpu_times[0]) ? (curr_cpu_times[0] - prev_cpu_times[0]) : 0;
-    }
-    if (total_diff == 0) total_diff = 1;
-
-    std::unordered_map<int, unsigned long long> seen_pids;
-
-    while ((ent = readdir(pd)) != nullptr) {
-        if (ent->d_type != DT_DIR) continue;
-        std::string name = ent->d_name;
-        if (!std::all_of(name.begin(), name.end(), ::isdigit)) continue;
-        int pid = std::stoi(name);
-
-        // read /proc/<pid>/stat
-        std::string statpath = "/proc/" + name + "/stat";
-        std::ifstream s(statpath);
-        if (!s) continue;
-        std::string statline;
-        std::getline(s, statline);
-        // parse: pid (comm) rest...
-        size_t pos = statline.find(')');
-        if (pos == std::string::npos) continue;
-        std::string comm = statline.substr(0, pos+1);
-        std::string rest = (pos+2 < statline.size()) ? statline.substr(pos+2) : std::string();
-        std::istringstream iss(rest);
-        // tokens: rest starts at field 3, so utime is tokens[11], stime tokens[12]
-        std::vector<std::string> toks;
-        std::string tok;
-        while (iss >> tok) toks.push_back(tok);
-        unsigned long long utime = 0, stime = 0;
-        if (toks.size() > 12) {
-            try { utime = std::stoull(toks[11]); } catch(...) { utime = 0; }
-            try { stime = std::stoull(toks[12]); } catch(...) { stime = 0; }
-        }
-        unsigned long long total_time = utime + stime;
-
-        // read VmRSS for memory
-        std::string statuspath = "/proc/" + name + "/status";
-        std::ifstream st(statuspath);
-        std::string line;
-        unsigned long vmrss = 0;
-        std::string proc_name = comm;
-        while (std::getline(st, line)) {
-            if (line.rfind("Name:",0)==0) {
-                std::istringstream is2(line);
-                std::string k, v; is2 >> k >> v; proc_name = v; }
-            if (line.rfind("VmRSS:",0)==0) { std::istringstream is2(line); std::string k; unsigned long v; is2 >> k >> v; vmrss = v; }
-        }
-
-        Process p;
-        p.pid = pid;
-        // sanitize name
-        if (!proc_name.empty() && proc_name.front()=='(' && proc_name.back()==')') proc_name = proc_name.substr(1, proc_name.size()-2);
-        p.name = proc_name;
+    // CPU% is ticks used over ticks elapsed on this collector's own clock
+    // (100% = one core), independent of when the CPU collector last ran
+    static const long ticks_per_sec = std::max(1L, sysconf(_SC_CLK_TCK));
+    double elapsed = sampleInterval(CollectProcesses, monotonicNs());
+    double elapsed_ticks = elapsed * ticks_per_sec;
 
-        // compute cpu percent using previous proc times
-        unsigned long long prev_pt = 0;
-        auto it = prev_proc_times.find(pid);
-        if (it != prev_proc_times.end()) prev_pt = it->second;
-        unsigned long long delta_proc = (total_time > prev_pt) ? (total_time - prev_pt) : 0;
-        int ncores = std::max(1, cpu_info.num_cores);
-        float cpu_pct = 0.0f;
-        if (total_diff > 0) cpu_pct = 100.0f * (float)delta_proc * (float)ncores / (float)total_diff;
-        p.cpu_percent = cpu_pct;
-        p.mem_percent = (memory_info.total==0)?0.0f:(100.0f * (float)vmrss / (float)memory_info.total);
+    // read and parse every /proc/<pid>/stat (sharded across the worker pool),
+    // then merge serially in PID order
+    size_t count = proc_scanner.scan();
+    const auto& recs = proc_scanner.records();
 
-        // store current proc time for next interval
-        prev_proc_times[pid] = total_time;
-        seen_pids[pid] = total_time;
+    proc_table.beginScan();
+    for (size_t i = 0; i < count; ++i) {
+        const ProcScanRecord& r = recs[i];
+        if (!r.ok) continue;
+        // update the persistent slot; a reused PID (new starttime) gets a
+        // fresh slot history instead of the previous owner's CPU delta
+        unsigned long long delta_proc = 0;
+        size_t slot = proc_table.update(r.pid, r.starttime, r.cpu_ticks, r.rss_pages * page_size_kb,
+                                        std::string_view(r.comm, r.comm_len), delta_proc);
+        proc_table.cpu_percent[slot] = (elapsed_ticks > 0.0) ? (float)(100.0 * delta_proc / elapsed_ticks) : 0.0f;
+    }
 
-        processes.push_back(p);
+    if (config.debug_mode) {
+        const ScanStats& ss = proc_scanner.lastStats();
+        debugLog("Process scan: " + std::to_string(ss.pids) + " pids via " + ProcessScanner::backendName(proc_scanner.backend()) +
+                 ", " + std::to_string(ss.syscalls) + " syscalls, " + std::to_string(ss.wall_ms) + " ms");
+    }
+    if (proc_scanner.fdCacheEnabled() && config.debug_mode) {
+        const StatFdCache& cache = proc_scanner.fdCache();
+        const auto& cs = cache.lastStats();
+        debugLog("Stat fd cache: " + std::to_string(cache.size()) + "/" + std::to_string(cache.limit()) +
+                 " open, " + std::to_string(cs.hits) + " hits (open syscalls saved), " +
+                 std::to_string(cs.opens) + " opens, " + std::to_string(cs.evictions) + " evicted, " +
+                 std::to_string(cs.uncached) + " over cap");
     }
-    closedir(pd);
 
-    // remove stale entries from prev_proc_times
-    for (auto it = prev_proc_times.begin(); it != prev_proc_times.end(); ) {
-        if (seen_pids.find(it->first) == seen_pids.end()) it = prev_proc_times.erase(it); else ++it;
+    // drop exited processes, then refresh the display list in place
+    proc_table.sweep();
+    size_t live = proc_table.size();
+    processes.resize(live);
+    for (size_t slot = 0; slot < live; ++slot) {
+        Process& p = processes[slot];
+        p.pid = proc_table.pids[slot];
+        p.name = proc_table.name(slot);
+        p.cpu_percent = proc_table.cpu_percent[slot];
+        p.mem_percent = (memory_info.total==0)?0.0f:(100.0f * (float)proc_table.rss_kb[slot] / (float)memory_info.total);
     }
 
     // sort according to current sort type
     sortProcesses();
 }
 
-void ActivityMonitor::updateMemoryStats() {
-    if (memory_info.total == 0) { memory_info.cache_hit_rate = -1.0f; memory_info.latency_ns = -1.0f; return; }
-    float cache_percentage = 100.0f * (float)(memory_info.cached + memory_info.buffers) / (float)memory_info.total;
-    memory_info.cache_hit_rate = 70.0f + cache_percentage * 0.25f;
-    if (memory_info.cache_hit_rate > 99.0f) memory_info.cache_hit_rate = 99.0f;
-    memory_info.latency_ns = 60.0f + (40.0f * memory_info.percent_used / 100.0f);
+// Read /proc/<pid>/status on demand for the process detail view. The
+// periodic scan never touches this file.
+bool ActivityMonitor::readProcessDetails(int pid, ProcessDetails& out) {
+    char path[64];
+    char buf[4096];
+    formatProcPath(path, pid, "status");
+    ssize_t n = readProcFile(path, buf, sizeof(buf));
+    if (n <= 0) return false;
+
+    out = ProcessDetails();
+    out.pid = pid;
+    std::istringstream iss(std::string(buf, (size_t)n));
+    std::string line;
+    while (std::getline(iss, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        size_t vpos = line.find_first_not_of(" \t", colon + 1);
+        std::string value = (vpos == std::string::npos) ? std::string() : line.substr(vpos);
+        if (key == "Name") out.name = value;
+        else if (key == "State") out.state = value;
+        else if (key == "PPid") out.ppid = std::atoi(value.c_str());
+        else if (key == "Uid") out.uid = std::atoi(value.c_str());
+        else if (key == "Threads") out.threads = std::atoi(value.c_str());
+        else if (key == "VmSize") out.vm_size_kb = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "VmRSS") out.vm_rss_kb = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "VmSwap") out.vm_swap_kb = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "voluntary_ctxt_switches") out.voluntary_ctxt_switches = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "nonvoluntary_ctxt_switches") out.nonvoluntary_ctxt_switches = std::strtoull(value.c_str(), nullptr, 10);
+    }
+    return true;
 }
 
-void ActivityMonitor::updateDiskLatency() {
-    // For demo, simulate latency based on usage
-    for (auto &d : disk_info) {
-        d.read_latency_ms = 1.0f + (d.percent_used / 100.0f) * 50.0f; // 1ms to ~51ms
+// Memory pressure rates from /proc/vmstat
+void ActivityMonitor::updateVmStat() {
+    if (vmstat_buf.empty()) vmstat_buf.resize(8 * 1024);
+    ssize_t n = readProcFileGrow("/proc/vmstat", vmstat_buf);
+    if (n < 0) return;
+    VmStatCounters cur;
+    if (!parseVmStat(vmstat_buf.data(), (size_t)n, cur)) return;
+
+    double seconds = sampleInterval(CollectVmStat, monotonicNs());
+    MemoryInfo& m = memory_info;
+    if (vmstat_sampled && seconds > 0) {
+        const VmStatCounters& prev = vmstat_prev;
+        auto rate = [seconds](unsigned long long c, unsigned long long p) {
+            return c >= p ? (float)((c - p) / seconds) : 0.0f;
+        };
+        m.major_faults_per_sec = rate(cur.pgmajfault, prev.pgmajfault);
+        m.minor_faults_per_sec = std::max(0.0f, rate(cur.pgfault, prev.pgfault) - m.major_faults_per_sec);
+        m.pgscan_per_sec = rate(cur.pgscan, prev.pgscan);
+        m.pgsteal_per_sec = rate(cur.pgsteal, prev.pgsteal);
+        m.swap_in_per_sec = rate(cur.pswpin, prev.pswpin);
+        m.swap_out_per_sec = rate(cur.pswpout, prev.pswpout);
+        m.refaults_per_sec = rate(cur.refault, prev.refault);
+        // a refault now may be for a page reclaimed in an earlier interval,
+        // hence the clamp
+        m.cache_effectiveness = (m.pgsteal_per_sec > 0.0f)
+            ? 100.0f * (1.0f - std::min(1.0f, m.refaults_per_sec / m.pgsteal_per_sec)) : -1.0f;
     }
+    vmstat_prev = cur;
+    vmstat_sampled = true;
+    pushHistory(CollectVmStat, steadyMs());
 }
 
-// Read network totals from /proc/net/dev and compute KB/s rates
+// Per-disk rates from /proc/diskstats. Whole disks come from /sys/block;
+// partitions only serve to map mounts onto their disk.
 void ActivityMonitor::updateDiskIOInfo() {
-    // Read /proc/diskstats for all disks
-    std::ifstream f("/proc/diskstats");
-    if (!f) return;
-    
-    unsigned long long total_reads = 0, total_writes = 0;
-    unsigned long long total_read_sectors = 0, total_write_sectors = 0;
-    unsigned long long total_io_ticks = 0;
-    
-    std::string line;
-    while (std::getline(f, line)) {
-        std::istringstream iss(line);
-        int major, minor;
-        std::string device_name;
-        unsigned long long reads, read_merges, read_sectors, read_ms;
-        unsigned long long writes, write_merges, write_sectors, write_ms;
-        unsigned long long ios_in_progress, io_ms, weighted_io_ms;
-        
-        // Parse /proc/diskstats format
-        if (!(iss >> major >> minor >> device_name >> reads >> read_merges 
-              >> read_sectors >> read_ms >> writes >> write_merges 
-              >> write_sectors >> write_ms >> ios_in_progress 
-              >> io_ms >> weighted_io_ms)) {
-            continue;
+    if (diskstats_buf.empty()) diskstats_buf.resize(16 * 1024);
+    ssize_t n = readProcFileGrow("/proc/diskstats", diskstats_buf);
+    if (n < 0) return;
+
+    uint64_t now = monotonicNs();
+    double seconds = sampleInterval(CollectDiskIO, now);
+    std::vector<BlockDevice>& disks = block_devices.disks();
+
+    // a different number of lines means a device was added or removed
+    const char* end = diskstats_buf.data() + n;
+    size_t lines = (size_t)std::count(static_cast<const char*>(diskstats_buf.data()), end, '\n');
+    if (lines != diskstats_lines) {
+        block_devices.scan();
+        diskstats_lines = lines;
+        diskio_mount_generation = ~0u;
+    }
+
+    std::vector<std::pair<int, DiskCounters>> samples;
+    for (const char* p = diskstats_buf.data(); p < end;) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+        //   major minor name reads rd_merges rd_sectors rd_ms writes wr_merges
+        //   wr_sectors wr_ms in_flight io_ms weighted_io_ms ...
+        unsigned long long f[14] = {};
+        const char* q = p;
+        int nf = 0;
+        while (q < eol && nf < 14) {
+            while (q < eol && *q == ' ') ++q;
+            if (nf == 2) {
+                while (q < eol && *q != ' ') ++q; // name
+            } else {
+                q = parseDecimal(q, eol, f[nf]);
+            }
+            ++nf;
         }
-        
-        // Skip loop devices and partitions, focus on main disks (sda, nvme0n1, etc.)
-        if (device_name.find("loop") != std::string::npos || 
-            device_name.find("ram") != std::string::npos ||
-            (device_name.size() > 3 && std::isdigit(device_name.back()))) {
-            continue;
+        p = eol + 1;
+        if (nf < 14) continue;
+
+        int idx = block_devices.diskOf((unsigned)f[0], (unsigned)f[1]);
+        if (idx < 0 || disks[idx].major != f[0] || disks[idx].minor != f[1]) continue; // partition
+        DiskCounters c;
+        c.reads = f[3];
+        c.read_sectors = f[5];
+        c.read_ms = f[6];
+        c.writes = f[7];
+        c.write_sectors = f[9];
+        c.write_ms = f[10];
+        c.io_ms = f[12];
+        c.weighted_io_ms = f[13];
+        samples.emplace_back(idx, c);
+    }
+
+    // which filesystem lives on each disk; only redone when mounts change
+    if (diskio_mount_generation != mount_table.generation()) {
+        for (BlockDevice& d : disks) d.mount_point.clear();
+        for (const MountEntry& m : mount_table.mounts()) {
+            int idx = block_devices.diskOf(m.major, m.minor);
+            if (idx >= 0 && disks[idx].mount_point.empty()) disks[idx].mount_point = m.mount_point;
         }
-        
-        total_reads += reads;
-        total_writes += writes;
-        total_read_sectors += read_sectors;
-        total_write_sectors += write_sectors;
-        total_io_ticks += io_ms;
+        diskio_mount_generation = mount_table.generation();
     }
-    
-    // Calculate rates using time delta
-    auto now = std::chrono::high_resolution_clock::now();
-    static auto prev_time = std::chrono::high_resolution_clock::now();
-    double seconds = std::chrono::duration<double>(now - prev_time).count();
-    if (seconds <= 0 || seconds > 10.0) seconds = 1.0; // Sanity check
-    
-    // Calculate read/write rates
-    if (diskio_info.prev_reads > 0) {
-        // Sector size is typically 512 bytes
-        unsigned long long read_bytes = (total_read_sectors - diskio_info.prev_read_sectors) * 512;
-        unsigned long long write_bytes = (total_write_sectors - diskio_info.prev_write_sectors) * 512;
-        
-        diskio_info.read_mb_per_sec = static_cast<float>(read_bytes / seconds / (1024.0 * 1024.0));
-        diskio_info.write_mb_per_sec = static_cast<float>(write_bytes / seconds / (1024.0 * 1024.0));
-        
-        diskio_info.read_ops_per_sec = static_cast<float>((total_reads - diskio_info.prev_reads) / seconds);
-        diskio_info.write_ops_per_sec = static_cast<float>((total_writes - diskio_info.prev_writes) / seconds);
-        
-        // I/O busy percentage (io_ticks is in milliseconds)
-        unsigned long long io_delta = total_io_ticks - diskio_info.prev_io_ticks;
-        diskio_info.io_busy_percent = std::min(100.0f, static_cast<float>(io_delta / (seconds * 10.0)));
-    } else {
-        diskio_info.read_mb_per_sec = 0.0f;
-        diskio_info.write_mb_per_sec = 0.0f;
-        diskio_info.read_ops_per_sec = 0.0f;
-        diskio_info.write_ops_per_sec = 0.0f;
-        diskio_info.io_busy_percent = 0.0f;
+
+    // counters only go up; anything else (a replaced device) restarts the rate
+    auto delta = [](unsigned long long cur, unsigned long long prev) { return cur >= prev ? cur - prev : 0ULL; };
+    const double mb = 1024.0 * 1024.0;
+    DiskIOInfo& io = diskio_info;
+    io.read_mb_per_sec = io.write_mb_per_sec = 0.0f;
+    io.read_ops_per_sec = io.write_ops_per_sec = 0.0f;
+    io.io_busy_percent = 0.0f;
+    io.devices.clear();
+    for (const auto& s : samples) {
+        BlockDevice& d = disks[s.first];
+        const DiskCounters& c = s.second;
+        bool first = !d.sampled;
+        DiskCounters prev = d.last;
+        d.last = c;
+        d.sampled = true;
+        if (c.reads == 0 && c.writes == 0) continue; // never used (idle loop, ram)
+
+        DiskDeviceIO dev;
+        dev.name = d.name;
+        dev.mount_point = d.mount_point;
+        dev.in_totals = BlockDeviceTable::countsInTotals(d);
+        if (!first && seconds > 0) {
+            unsigned long long reads = delta(c.reads, prev.reads);
+            unsigned long long writes = delta(c.writes, prev.writes);
+            // diskstats sectors are always 512 bytes
+            dev.read_mb_per_sec = (float)(delta(c.read_sectors, prev.read_sectors) * 512 / seconds / mb);
+            dev.write_mb_per_sec = (float)(delta(c.write_sectors, prev.write_sectors) * 512 / seconds / mb);
+            dev.read_ops_per_sec = (float)(reads / seconds);
+            dev.write_ops_per_sec = (float)(writes / seconds);
+            if (reads + writes > 0)
+                dev.await_ms = (float)(delta(c.read_ms, prev.read_ms) + delta(c.write_ms, prev.write_ms)) / (reads + writes);
+            dev.queue_depth = (float)(delta(c.weighted_io_ms, prev.weighted_io_ms) / (seconds * 1000.0));
+            dev.util_percent = std::min(100.0f, (float)(delta(c.io_ms, prev.io_ms) / (seconds * 10.0)));
+        }
+        if (dev.in_totals) {
+            io.read_mb_per_sec += dev.read_mb_per_sec;
+            io.write_mb_per_sec += dev.write_mb_per_sec;
+            io.read_ops_per_sec += dev.read_ops_per_sec;
+            io.write_ops_per_sec += dev.write_ops_per_sec;
+            io.io_busy_percent = std::max(io.io_busy_percent, dev.util_percent);
+        }
+        io.devices.push_back(std::move(dev));
     }
-    
-    // Update previous values
-    diskio_info.prev_reads = total_reads;
-    diskio_info.prev_writes = total_writes;
-    diskio_info.prev_read_sectors = total_read_sectors;
-    diskio_info.prev_write_sectors = total_write_sectors;
-    diskio_info.prev_io_ticks = total_io_ticks;
-    prev_time = now;
-    
-    // Store history
-    if (diskio_read_history.size() >= history_length) diskio_read_history.erase(diskio_read_history.begin());
-    if (diskio_write_history.size() >= history_length) diskio_write_history.erase(diskio_write_history.begin());
-    diskio_read_history.push_back(diskio_info.read_mb_per_sec);
-    diskio_write_history.push_back(diskio_info.write_mb_per_sec);
+
+    pushHistory(CollectDiskIO, steadyMs());
+}
+
+void ActivityMonitor::updateNetInfo() {
+    if (netdev_buf.empty()) netdev_buf.resize(8 * 1024);
+    ssize_t n = readProcFileGrow("/proc/net/dev", netdev_buf);
+    if (n < 0) return;
+    uint64_t now = monotonicNs();
+    double seconds = sampleInterval(CollectNet, now);
+    if (!net_interfaces.parse(netdev_buf.data(), (size_t)n, netdev_counters)) return;
+    std::vector<NetInterface>& ifaces = net_interfaces.interfaces();
+
+    // hand out history slots when the interface list changes; an interface
+    // keeps its slot for as long as it exists
+    if (net_generation != net_interfaces.generation()) {
+        bool used[kNetHistorySlots] = {};
+        for (const NetInterface& i : ifaces)
+            if (i.history_slot >= 0) used[i.history_slot] = true;
+        int next = 0;
+        for (NetInterface& i : ifaces) {
+            if (i.history_slot >= 0) continue;
+            while (next < kNetHistorySlots && used[next]) ++next;
+            if (next == kNetHistorySlots) break;
+            i.history_slot = next;
+            used[next] = true;
+            net_rx_history[next].clear();
+            net_tx_history[next].clear();
+        }
+        net_generation = net_interfaces.generation();
+    }
+
+    // Totals count physical NICs, so traffic routed through a bridge or veth
+    // is not counted twice. Inside a container there may be none; then
+    // everything but loopback counts.
+    bool any_physical = false;
+    for (const NetInterface& i : ifaces) any_physical |= i.physical;
+
+    auto delta = [](unsigned long long cur, unsigned long long prev) { return cur >= prev ? cur - prev : 0ULL; };
+    const double mb = 1024.0 * 1024.0;
+    NetInfo& net = net_info;
+    net.rx_mb_per_sec = net.tx_mb_per_sec = 0.0f;
+    net.rx_packets_per_sec = net.tx_packets_per_sec = 0.0f;
+    net.drops_per_sec = net.errors_per_sec = 0.0f;
+    net.interfaces.clear();
+    for (size_t k = 0; k < ifaces.size(); ++k) {
+        NetInterface& i = ifaces[k];
+        const NetDevCounters& c = netdev_counters[k];
+        bool first = !i.sampled;
+        NetDevCounters prev = i.last;
+        i.last = c;
+        i.sampled = true;
+        if (c.rx_packets == 0 && c.tx_packets == 0) continue; // never used
+
+        NetInterfaceIO io;
+        io.name = i.name;
+        io.in_totals = !i.loopback && (i.physical || !any_physical);
+        io.history_slot = i.history_slot;
+        if (!first && seconds > 0) {
+            double rx_bytes = (double)delta(c.rx_bytes, prev.rx_bytes);
+            double tx_bytes = (double)delta(c.tx_bytes, prev.tx_bytes);
+            io.rx_mb_per_sec = (float)(rx_bytes / seconds / mb);
+            io.tx_mb_per_sec = (float)(tx_bytes / seconds / mb);
+            io.rx_packets_per_sec = (float)(delta(c.rx_packets, prev.rx_packets) / seconds);
+            io.tx_packets_per_sec = (float)(delta(c.tx_packets, prev.tx_packets) / seconds);
+            io.drops_per_sec = (float)((delta(c.rx_dropped, prev.rx_dropped) + delta(c.tx_dropped, prev.tx_dropped)) / seconds);
+            io.errors_per_sec = (float)((delta(c.rx_errors, prev.rx_errors) + delta(c.tx_errors, prev.tx_errors)) / seconds);
+            // links are full duplex, so the busier direction is what saturates
+            if (i.speed_mbps > 0)
+                io.util_percent = std::min(100.0f, (float)(std::max(rx_bytes, tx_bytes) * 8 / seconds / (i.speed_mbps * 1e6) * 100.0));
+        }
+        if (io.in_totals) {
+            net.rx_mb_per_sec += io.rx_mb_per_sec;
+            net.tx_mb_per_sec += io.tx_mb_per_sec;
+            net.rx_packets_per_sec += io.rx_packets_per_sec;
+            net.tx_packets_per_sec += io.tx_packets_per_sec;
+            net.drops_per_sec += io.drops_per_sec;
+            net.errors_per_sec += io.errors_per_sec;
+        }
+        net.interfaces.push_back(std::move(io));
+    }
+    pushHistory(CollectNet, steadyMs());
 }
 
 // Read thermal sensors if available (/sys/class/thermal)
@@ -433,41 +1024,115 @@ void ActivityMonitor::updateSystemInfo() {
         loadavg_file.close();
     }
 
-    // Read context switches and interrupts from /proc/stat
-    std::ifstream stat_file("/proc/stat");
-    if (stat_file) {
-        std::string line;
-        while (std::getline(stat_file, line)) {
-            if (line.rfind("ctxt ", 0) == 0) {
-                std::istringstream iss(line);
-                std::string label;
-                iss >> label >> system_info.total_ctx_switches;
-            } else if (line.rfind("intr ", 0) == 0) {
-                std::istringstream iss(line);
-                std::string label;
-                unsigned long long first_val;
-                iss >> label >> first_val;
-                system_info.total_interrupts = first_val;
-            }
-        }
-        stat_file.close();
-    }
+    // Context switches, interrupts and task counts from the shared /proc/stat snapshot
+    system_info.total_ctx_switches = system_stat.ctxt;
+    system_info.total_interrupts = system_stat.intr_total;
+    system_info.total_forks = system_stat.processes;
+    system_info.procs_running = system_stat.procs_running;
+    system_info.procs_blocked = system_stat.procs_blocked;
 
-    // Calculate rates (per second)
-    static auto last_time = std::chrono::steady_clock::now();
-    auto now = std::chrono::steady_clock::now();
-    double elapsed = std::chrono::duration<double>(now - last_time).count();
+    // Rates per second between the /proc/stat reads this collector used
+    double elapsed = sampleInterval(CollectSystem, stat_read_ns);
     
     if (elapsed > 0 && system_info.prev_ctx_switches > 0) {
         system_info.ctx_switches_per_sec = 
             (system_info.total_ctx_switches - system_info.prev_ctx_switches) / elapsed;
         system_info.interrupts_per_sec = 
             (system_info.total_interrupts - system_info.prev_interrupts) / elapsed;
+        system_info.forks_per_sec =
+            (system_info.total_forks - system_info.prev_forks) / elapsed;
     }
 
     system_info.prev_ctx_switches = system_info.total_ctx_switches;
     system_info.prev_interrupts = system_info.total_interrupts;
-    last_time = now;
+    system_info.prev_forks = system_info.total_forks;
+}
+
+// Pressure stall averages of cpu, memory and io
+void ActivityMonitor::updatePressure() {
+    static const char* const paths[PsiResourceCount] = {
+        "/proc/pressure/cpu", "/proc/pressure/memory", "/proc/pressure/io"};
+    char buf[512];
+    pressure_info.available = false;
+    for (int r = 0; r < PsiResourceCount; ++r) {
+        PsiResource& res = pressure_info.resource[r];
+        ssize_t n = readProcFile(paths[r], buf, sizeof(buf));
+        if (n > 0 && parsePressure(buf, (size_t)n, res)) pressure_info.available = true;
+        else res = PsiResource();
+    }
+    pushHistory(CollectPressure, steadyMs());
+}
+
+void ActivityMonitor::pushHistory(int collector, uint64_t now_ms) {
+    collected_mask |= bit(collector);
+    switch (collector) {
+    case CollectCPU:
+        total_history.push(cpu_info.total_usage);
+        total_rollup.add(cpu_info.total_usage, now_ms);
+        // per-core rings were sized in setConfig; only grow (existing rings keep
+        // their storage, which published snapshots may still point into)
+        while (cpu_history.size() < static_cast<size_t>(cpu_info.num_cores)) {
+            cpu_history.emplace_back(history_length);
+        }
+        for (int i = 0; i < cpu_info.num_cores && i < (int)cpu_info.core_usage.size(); ++i)
+            cpu_history[i].push(cpu_info.core_usage[i]);
+        break;
+    case CollectMemory:
+        mem_history.push(memory_info.percent_used);
+        swap_history.push(memory_info.swap_percent_used);
+        mem_rollup.add(memory_info.percent_used, now_ms);
+        swap_rollup.add(memory_info.swap_percent_used, now_ms);
+        break;
+    case CollectVmStat: {
+        const MemoryInfo& m = memory_info;
+        float swapio = m.swap_in_per_sec + m.swap_out_per_sec;
+        majflt_history.push(m.major_faults_per_sec);
+        swapio_history.push(swapio);
+        refault_history.push(m.refaults_per_sec);
+        majflt_rollup.add(m.major_faults_per_sec, now_ms);
+        swapio_rollup.add(swapio, now_ms);
+        refault_rollup.add(m.refaults_per_sec, now_ms);
+        break;
+    }
+    case CollectDiskIO:
+        diskio_read_history.push(diskio_info.read_mb_per_sec);
+        diskio_write_history.push(diskio_info.write_mb_per_sec);
+        diskio_read_rollup.add(diskio_info.read_mb_per_sec, now_ms);
+        diskio_write_rollup.add(diskio_info.write_mb_per_sec, now_ms);
+        break;
+    case CollectPressure:
+        for (int r = 0; r < PsiResourceCount; ++r) psi_some_history[r].push(pressure_info.resource[r].some.avg10);
+        break;
+    case CollectNet:
+        for (NetInterfaceIO& io : net_info.interfaces) {
+            if (io.history_slot < 0 || io.history_slot >= kNetHistorySlots) {
+                io.rx_history = io.tx_history = Span<float>();
+                continue;
+            }
+            net_rx_history[io.history_slot].push(io.rx_mb_per_sec);
+            net_tx_history[io.history_slot].push(io.tx_mb_per_sec);
+            io.rx_history = net_rx_history[io.history_slot].span();
+            io.tx_history = net_tx_history[io.history_slot].span();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void ActivityMonitor::clearHistories() {
+    for (auto& h : cpu_history) h.clear();
+    for (RingBuffer<float>* h : {&total_history, &mem_history, &swap_history, &majflt_history, &swapio_history,
+                                 &refault_history, &diskio_read_history, &diskio_write_history})
+        h->clear();
+    for (auto& h : psi_some_history) h.clear();
+    for (int i = 0; i < kNetHistorySlots; ++i) {
+        net_rx_history[i].clear();
+        net_tx_history[i].clear();
+    }
+    for (RollupHistory* r : {&total_rollup, &mem_rollup, &swap_rollup, &majflt_rollup, &swapio_rollup,
+                             &refault_rollup, &diskio_read_rollup, &diskio_write_rollup})
+        r->clear();
 }
 
 std::string ActivityMonitor::formatSize(unsigned long size_kb) {
@@ -478,13 +1143,6 @@ std::string ActivityMonitor::formatSize(unsigned long size_kb) {
     return oss.str();
 }
 
-std::string ActivityMonitor::formatLatency(float latency, bool is_memory) {
-    std::ostringstream oss; oss << std::fixed << std::setprecision(2);
-    if (latency < 0) return "N/A";
-    if (is_memory) oss << latency << " ns"; else oss << latency << " ms";
-    return oss.str();
-}
-
 std::string ActivityMonitor::createBar(float percent, int width, bool) {
     if (width < 10) width = 10;
     int barw = width - 7; // space for percent
@@ -500,6 +1158,7 @@ std::string ActivityMonitor::createBar(float percent, int width, bool) {
 
 void ActivityMonitor::debugLog(const std::string& msg) {
     if (!config.debug_mode) return;
+    std::lock_guard<std::mutex> lock(debug_mutex);
     if (!debug_file.is_open()) debug_file.open("activity_monitor_debug.log", std::ios::out | std::ios::app);
     debug_file << msg << std::endl;
     std::cerr << "DEBUG: " << msg << std::endl;
@@ -540,15 +1199,15 @@ bool ActivityMonitor::killProcess(int pid) {
     }
 
     // Refresh data and provide feedback to the user
-    collectData();
+    requestRefresh();
     if (success) displayMessage("Process " + std::to_string(pid) + " terminated successfully.");
     else displayMessage("Failed to terminate process " + std::to_string(pid) + ". Check permissions.");
     return success;
 }
 
 void ActivityMonitor::killHighestCPUProcess() {
-    if (processes.empty()) return;
-    int pid = processes[0].pid;
+    if (view->processes.empty()) return;
+    int pid = view->processes[0].pid;
     killProcess(pid);
 }
 
@@ -583,7 +1242,11 @@ void ActivityMonitor::handleInput(int ch) {
     // Normal mode input
     switch (ch) {
         case 'q': running = false; break;
-        case 'r': collectData(); break;
+        case 'r': requestRefresh(); break;
+        case 'o': // self-overhead overlay
+            show_overlay = !show_overlay;
+            if (!show_overlay) invalidatePanels();
+            break;
         case 'z':
             // Toggle CPU zoom mode between dynamic and fixed 0-100
             cpu_zoom_dynamic = !cpu_zoom_dynamic;
@@ -592,6 +1255,23 @@ void ActivityMonitor::handleInput(int ch) {
             // Toggle CPU display mode between per-core and total
             cpu_mode_per_core = !cpu_mode_per_core;
             break;
+        case 'h':
+            // Cycle graph time span: raw -> 1s -> 10s -> 1m -> 10m
+            history_tier = (history_tier + 1 < RollupHistory::kTiers) ? history_tier + 1 : -1;
+            requestRefresh(); // snapshots carry only the tier shown
+            break;
+        case 'v': mem_pressure_view = !mem_pressure_view; break;
+        case '[': // replay: previous / next keyframe
+        case ']':
+            if (replay) replaySeek(ch == '[' ? -1 : 1);
+            break;
+        case ' ':
+            if (replay) {
+                replay_paused = !replay_paused;
+                replay_origin_ns = monotonicNs(); // resume from the frame shown
+                replay_origin_ms = replay_t_ms;
+            }
+            break;
         case '/': // Enter search mode
         case 's':
             search_mode = true;
@@ -600,8 +1280,13 @@ void ActivityMonitor::handleInput(int ch) {
             process_list_offset = 0;
             break;
         case 'k': {
+            // the PIDs of a recording are not this system's processes
+            if (replay) {
+                displayMessage("Not available in a replay");
+                break;
+            }
             // kill selected process if any
-            auto& proc_list = search_query.empty() ? processes : filtered_processes;
+            const auto& proc_list = search_query.empty() ? view->processes : filtered_processes;
             if (!proc_list.empty() && process_selected >= 0 && process_selected < (int)proc_list.size()) {
                 int pid = proc_list[process_selected].pid;
                 std::ostringstream oss; oss << "Kill process " << pid << " (" << proc_list[process_selected].name << ")?";
@@ -609,10 +1294,23 @@ void ActivityMonitor::handleInput(int ch) {
             }
             break;
         }
-        case 'c': process_sort_type = 0; sortProcesses(); break;
-        case 'm': process_sort_type = 1; sortProcesses(); break;
+        case 'i': {
+            if (replay) {
+                displayMessage("Not available in a replay");
+                break;
+            }
+            // detail view for the selected process (reads /proc/<pid>/status lazily)
+            const auto& proc_list = search_query.empty() ? view->processes : filtered_processes;
+            if (!proc_list.empty() && process_selected >= 0 && process_selected < (int)proc_list.size()) {
+                displayProcessDetails(proc_list[process_selected].pid);
+            }
+            break;
+        }
+        // the collector sorts; ask it for a tick so the new order shows now
+        case 'c': process_sort_type = 0; requestRefresh(); break;
+        case 'm': process_sort_type = 1; requestRefresh(); break;
         case KEY_UP: {
-            auto& proc_list = search_query.empty() ? processes : filtered_processes;
+            const auto& proc_list = search_query.empty() ? view->processes : filtered_processes;
             if (process_selected > 0) {
                 process_selected--;
                 if (process_selected < process_list_offset) process_list_offset = process_selected;
@@ -620,7 +1318,7 @@ void ActivityMonitor::handleInput(int ch) {
             break;
         }
         case KEY_DOWN: {
-            auto& proc_list = search_query.empty() ? processes : filtered_processes;
+            const auto& proc_list = search_query.empty() ? view->processes : filtered_processes;
             if (process_selected < (int)proc_list.size() - 1) {
                 process_selected++;
                 int rows = terminal_height / 2 - 3;
@@ -633,7 +1331,7 @@ void ActivityMonitor::handleInput(int ch) {
             process_selected = std::max(0, process_selected - 10);
             break;
         case KEY_NPAGE: {
-            auto& proc_list = search_query.empty() ? processes : filtered_processes;
+            const auto& proc_list = search_query.empty() ? view->processes : filtered_processes;
             process_list_offset = std::min(std::max(0, (int)proc_list.size()-1), process_list_offset + 10);
             process_selected = std::min((int)proc_list.size()-1, process_selected + 10);
             break;
@@ -641,7 +1339,7 @@ void ActivityMonitor::handleInput(int ch) {
         case KEY_HOME:
             process_list_offset = 0; process_selected = 0; break;
         case KEY_END: {
-            auto& proc_list = search_query.empty() ? processes : filtered_processes;
+            const auto& proc_list = search_query.empty() ? view->processes : filtered_processes;
             process_list_offset = std::max(0, (int)proc_list.size() - 1); 
             process_selected = std::max(0, (int)proc_list.size() - 1); 
             break;
@@ -656,7 +1354,84 @@ void ActivityMonitor::runDebugMode() {
     debugLog("=== Debug-only mode output ===");
     debugLog("CPU: " + std::to_string(cpu_info.total_usage));
     debugLog("Memory: " + std::to_string(memory_info.percent_used));
+    {
+        const MemoryInfo& m = memory_info;
+        char line[200];
+        snprintf(line, sizeof(line), "VM: major faults %.1f/s minor %.1f/s scan %.1f/s steal %.1f/s "
+                 "swap in %.1f/s out %.1f/s refaults %.1f/s cache %.1f%%",
+                 m.major_faults_per_sec, m.minor_faults_per_sec, m.pgscan_per_sec, m.pgsteal_per_sec,
+                 m.swap_in_per_sec, m.swap_out_per_sec, m.refaults_per_sec, m.cache_effectiveness);
+        debugLog(line);
+    }
     for (auto &d : disk_info) debugLog("Disk: " + d.mount_point + " " + formatSize(d.total_space));
+    for (int r = 0; pressure_info.available && r < PsiResourceCount; ++r) {
+        const PsiResource& p = pressure_info.resource[r];
+        char line[160];
+        snprintf(line, sizeof(line), "PSI %s: some %.2f/%.2f full %.2f/%.2f (avg10/avg60)", psiResourceName(r),
+                 p.some.avg10, p.some.avg60, p.full.avg10, p.full.avg60);
+        debugLog(line);
+    }
+    for (const NetInterfaceIO& n : net_info.interfaces) {
+        char line[200];
+        snprintf(line, sizeof(line), "Net: %s%s rx %.3f MB/s %.0f pkt/s tx %.3f MB/s %.0f pkt/s drops %.1f/s errors %.1f/s util %.1f%%",
+                 n.name.c_str(), n.in_totals ? "" : " [not in totals]", n.rx_mb_per_sec, n.rx_packets_per_sec,
+                 n.tx_mb_per_sec, n.tx_packets_per_sec, n.drops_per_sec, n.errors_per_sec, n.util_percent);
+        debugLog(line);
+    }
+    for (const DiskDeviceIO& d : diskio_info.devices) {
+        char line[160];
+        snprintf(line, sizeof(line), "Disk I/O: %s (%s)%s read %.2f MB/s write %.2f MB/s await %.2f ms qd %.2f util %.1f%%",
+                 d.name.c_str(), d.mount_point.empty() ? "-" : d.mount_point.c_str(), d.in_totals ? "" : " [not in totals]",
+                 d.read_mb_per_sec, d.write_mb_per_sec, d.await_ms, d.queue_depth, d.util_percent);
+        debugLog(line);
+    }
+
+    OverheadStats overhead;
+    fillOverhead(overhead);
+    std::vector<std::string> report;
+    overheadReport(overhead, report);
+    for (const std::string& line : report) debugLog(line);
+    if (config.overhead_summary)
+        for (const std::string& line : report) std::cout << line << "\n";
+}
+
+static std::string histRow(const char* label, const HistogramSummary& h, double scale) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%-14s %8llu %9.1f %9.1f %9.1f %9.1f", label, (unsigned long long)h.total,
+             h.mean / scale, h.p50 / scale, h.p99 / scale, h.max / scale);
+    return buf;
+}
+
+void ActivityMonitor::overheadReport(const OverheadStats& o, std::vector<std::string>& out) {
+    char buf[128];
+    out.clear();
+    snprintf(buf, sizeof(buf), "Time in us, last %zu samples each", RollingHistogram::kWindow);
+    out.push_back(buf);
+    snprintf(buf, sizeof(buf), "%-14s %8s %9s %9s %9s %9s", "", "calls", "mean", "p50", "p99", "max");
+    out.push_back(buf);
+    for (int c = 0; c < CollectorCount; ++c) out.push_back(histRow(collectorName(c), o.collector_ns[c], 1000.0));
+    out.push_back(histRow("collect tick", o.tick_ns, 1000.0));
+    for (int p = 0; p < PanelCount; ++p) {
+        std::string label = std::string("panel ") + panelName(p);
+        out.push_back(histRow(label.c_str(), panel_hist[p].summary(), 1000.0));
+    }
+    out.push_back(histRow("frame+output", frame_hist.summary(), 1000.0));
+
+    static const long ticks_per_sec = sysconf(_SC_CLK_TCK);
+    snprintf(buf, sizeof(buf), "CPU %.2f s total, per tick p50 %.2f%% p99 %.2f%% max %.2f%%",
+             (double)o.usage.cpu_ticks / (ticks_per_sec > 0 ? ticks_per_sec : 100),
+             o.cpu_pct_x100.p50 / 100.0, o.cpu_pct_x100.p99 / 100.0, o.cpu_pct_x100.max / 100.0);
+    out.push_back(buf);
+    snprintf(buf, sizeof(buf), "RSS %s", formatSize((unsigned long)(o.usage.rss_pages * o.page_size_kb)).c_str());
+    out.push_back(buf);
+    snprintf(buf, sizeof(buf), "Minor faults %llu total, per tick p50 %llu p99 %llu max %llu", o.usage.minor_faults,
+             (unsigned long long)o.minor_faults.p50, (unsigned long long)o.minor_faults.p99,
+             (unsigned long long)o.minor_faults.max);
+    out.push_back(buf);
+    snprintf(buf, sizeof(buf), "Read/write syscalls %llu total, per tick p50 %llu p99 %llu max %llu", o.usage.syscalls,
+             (unsigned long long)o.syscalls.p50, (unsigned long long)o.syscalls.p99,
+             (unsigned long long)o.syscalls.max);
+    out.push_back(buf);
 }
 
 void ActivityMonitor::sortProcesses() {
@@ -671,6 +1446,4 @@ void ActivityMonitor::sortProcesses() {
             return a.mem_percent > b.mem_percent;
         });
     }
-    // clamp selection
-    if (process_selected >= (int)processes.size()) process_selected = std::max(0, (int)processes.size() - 1);
 }
@@ -1,4 +1,5 @@
 #include "../include/monitor.h"
+#include "../include/procfs.h"
 #include <ncurses.h>
 #include <thread>
 #include <chrono>
@@ -7,6 +8,12 @@
 #include <algorithm>
 #include <cmath>
 #include <sstream>
+#include <cerrno>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
 
 // Helper to cast void* windows in header back to WINDOW*
 static WINDOW* toWin(void* p) { return static_cast<WINDOW*>(p); }
@@ -35,23 +42,32 @@ void ActivityMonitor::initializeWindows() {
     // detect 256-color support
     use_256_colors = (COLORS >= 256);
 
-    getmaxyx(stdscr, terminal_height, terminal_width);
+    refresh(); // stdscr starts fully touched; flush it once so it never blanks the panels
+    layoutWindows();
+}
+
+const char* ActivityMonitor::panelName(int panel) {
+    static const char* const names[PanelCount] = {"sysinfo", "cpu", "memory", "disk", "diskio", "net", "process"};
+    return (panel >= 0 && panel < PanelCount) ? names[panel] : "?";
+}
 
+void ActivityMonitor::panelLayout(int rows, int cols, PanelRect out[PanelCount]) {
     int margin = 1;
-    int content_w = terminal_width - margin * 2;
+    int content_w = cols - margin * 2;
 
     // Layout matching user diagram:
     // Row 1: CPU (full width) with legend on right
-    // Row 2: System Info (left ~40%) | Disk (right ~60%)
+    // Row 2: System Info (left ~40%) | Disk | Network (~30% each)
     // Row 3: Process (left ~60%) | Memory + Disk I/O stacked (right ~40%)
     
-    int cpu_h = std::max(6, terminal_height / 4);
-    int mid_h = std::max(8, (terminal_height - cpu_h) / 3);
-    int bottom_h = terminal_height - cpu_h - mid_h - 2;
+    int cpu_h = std::max(6, rows / 4);
+    int mid_h = std::max(8, (rows - cpu_h) / 3);
+    int bottom_h = rows - cpu_h - mid_h - 2;
 
-    // Middle row split: System Info left, Disk right
+    // Middle row split: System Info left, Disk and Network right
     int sysinfo_w = std::max(20, (content_w * 4) / 10); // 40% for system info
-    int disk_w = content_w - sysinfo_w - 1;
+    int disk_w = (content_w - sysinfo_w - 2) / 2;
+    int net_w = content_w - sysinfo_w - disk_w - 2;
 
     // Bottom row split: Process left, Memory+Disk I/O right
     int process_w = std::max(30, (content_w * 6) / 10); // 60% for processes
@@ -61,48 +77,159 @@ void ActivityMonitor::initializeWindows() {
     int mem_h = std::max(5, bottom_h / 2);
     int diskio_h = bottom_h - mem_h - 1;
 
-    cpu_win = newwin(cpu_h, content_w, 0, margin);
-    sysinfo_win = newwin(mid_h, sysinfo_w, cpu_h, margin);
-    disk_win = newwin(mid_h, disk_w, cpu_h, margin + sysinfo_w + 1);
-    process_win = newwin(bottom_h, process_w, cpu_h + mid_h, margin);
-    mem_win = newwin(mem_h, right_col_w, cpu_h + mid_h, margin + process_w + 1);
-    diskio_win = newwin(diskio_h, right_col_w, cpu_h + mid_h + mem_h + 1, margin + process_w + 1);
+    out[PanelCPU] = {0, margin, cpu_h, content_w};
+    out[PanelSysInfo] = {cpu_h, margin, mid_h, sysinfo_w};
+    out[PanelDisk] = {cpu_h, margin + sysinfo_w + 1, mid_h, disk_w};
+    out[PanelNet] = {cpu_h, margin + sysinfo_w + disk_w + 2, mid_h, net_w};
+    out[PanelProcess] = {cpu_h + mid_h, margin, bottom_h, process_w};
+    out[PanelMem] = {cpu_h + mid_h, margin + process_w + 1, mem_h, right_col_w};
+    out[PanelDiskIO] = {cpu_h + mid_h + mem_h + 1, margin + process_w + 1, diskio_h, right_col_w};
 }
 
-void ActivityMonitor::resizeWindows() {
-    int h, w;
-    getmaxyx(stdscr, h, w);
-    if (h == terminal_height && w == terminal_width) return;
+// Create the panel windows for the current terminal size
+void ActivityMonitor::layoutWindows() {
+    getmaxyx(stdscr, terminal_height, terminal_width);
+
+    PanelRect r[PanelCount];
+    panelLayout(terminal_height, terminal_width, r);
+    void** wins[PanelCount] = {&sysinfo_win, &cpu_win, &mem_win, &disk_win, &diskio_win, &net_win, &process_win};
+    for (int p = 0; p < PanelCount; ++p) {
+        *wins[p] = newwin(r[p].h, r[p].w, r[p].y, r[p].x);
+        panel_surfaces[p].reset(new NcursesSurface(*wins[p]));
+    }
+    invalidatePanels();
+}
+
+// Force a full redraw of every panel on the next frame
+void ActivityMonitor::invalidatePanels() {
+    for (bool& v : panel_valid) v = false;
+    restage_screen = true;
+    cpu_canvas.invalidate();
+    mem_canvas.invalidate();
+}
+
+// Returns true (and records the key) if the panel must be redrawn
+bool ActivityMonitor::panelChanged(int panel, uint64_t key) {
+    if (panel_valid[panel] && panel_keys[panel] == key) return false;
+    panel_valid[panel] = true;
+    panel_keys[panel] = key;
+    ++frame_panels_drawn;
+    return true;
+}
 
-    terminal_height = h;
-    terminal_width = w;
+// Bytes this thread has passed to write() so far, and the number of write
+// calls (wchar/syscw in /proc/thread-self/io). Taken around doupdate() they
+// are exactly what ncurses sent to the terminal for one frame.
+static void threadWriteCounters(unsigned long long& bytes, unsigned long long& calls) {
+    char buf[512];
+    bytes = calls = 0;
+    ssize_t n = readProcFile("/proc/thread-self/io", buf, sizeof(buf));
+    if (n <= 0) return;
+    const char* end = buf + n;
+    const char* p = strstr(buf, "wchar:");
+    if (p) parseDecimal(p + 7, end, bytes);
+    p = strstr(buf, "syscw:");
+    if (p) parseDecimal(p + 7, end, calls);
+}
+
+// Draw every panel onto its surface, optionally timing each one
+void ActivityMonitor::drawPanels(Surface* const surfaces[PanelCount], double* panel_us) {
+    frame_panels_drawn = 0;
+    frame_graph_cols = 0;
+    for (int p = 0; p < PanelCount; ++p) {
+        uint64_t t0 = monotonicNs();
+        Surface& s = *surfaces[p];
+        switch (p) {
+        case PanelSysInfo: displaySystemInfo(s); break;
+        case PanelCPU: displayCPUInfo(s); break;
+        case PanelMem: displayMemoryInfo(s); break;
+        case PanelDisk: displayDiskInfo(s); break;
+        case PanelDiskIO: displayDiskIOInfo(s); break;
+        case PanelNet: displayNetInfo(s); break;
+        case PanelProcess: displayProcessInfo(s); break;
+        }
+        uint64_t ns = monotonicNs() - t0;
+        panel_hist[p].add(ns);
+        if (panel_us) panel_us[p] = ns / 1000.0;
+    }
+}
+
+void ActivityMonitor::renderPanels(const MonitorSnapshot& snap, Surface* const surfaces[PanelCount], double* panel_us) {
+    view = &snap;
+    drawPanels(surfaces, panel_us);
+}
+
+// One frame: each panel stages only what changed with wnoutrefresh (an
+// unchanged panel stages nothing) and a single doupdate() sends it all.
+void ActivityMonitor::renderFrame() {
+    uint64_t t0 = monotonicNs();
+    view = &snapshots.read(); // never blocks; latest complete snapshot
+
+    if (restage_screen) {
+        // the blank gaps between panels live on stdscr
+        touchwin(stdscr);
+        wnoutrefresh(stdscr);
+        restage_screen = false;
+    }
+    Surface* surfaces[PanelCount];
+    for (int p = 0; p < PanelCount; ++p) surfaces[p] = panel_surfaces[p].get();
+    drawPanels(surfaces, nullptr);
+    if (show_overlay) {
+        if (!overlay_win) {
+            int h = std::min(28, terminal_height);
+            int w = std::min(72, terminal_width);
+            overlay_win = newwin(h, w, (terminal_height - h) / 2, (terminal_width - w) / 2);
+        } else {
+            touchwin(toWin(overlay_win)); // panels drawn this frame may have covered it
+        }
+        NcursesSurface s(overlay_win);
+        displayOverlay(s);
+    } else if (overlay_win) {
+        delwin(toWin(overlay_win));
+        overlay_win = nullptr;
+    }
+    displayAlert();
+
+    unsigned long long bytes0 = 0, writes0 = 0;
+    if (config.debug_mode) threadWriteCounters(bytes0, writes0);
+    doupdate();
+    frame_hist.add(monotonicNs() - t0);
+    if (config.debug_mode) {
+        unsigned long long bytes1, writes1;
+        threadWriteCounters(bytes1, writes1);
+        ++frame_count;
+        frame_bytes_total += bytes1 - bytes0;
+        frame_writes_total += writes1 - writes0;
+        debugLog("Frame " + std::to_string(frame_count) + ": " + std::to_string(bytes1 - bytes0) + " bytes in " +
+                 std::to_string(writes1 - writes0) + " writes, " + std::to_string(frame_panels_drawn) + "/" +
+                 std::to_string((int)PanelCount) + " panels, " + std::to_string(frame_graph_cols) + " graph columns");
+    }
+}
+
+// Called on SIGWINCH: take the new size from the tty and rebuild the panels
+void ActivityMonitor::resizeWindows() {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0)
+        resizeterm(ws.ws_row, ws.ws_col);
+    clear();
+    refresh();
 
     if (sysinfo_win) delwin(toWin(sysinfo_win));
     if (cpu_win) delwin(toWin(cpu_win));
     if (mem_win) delwin(toWin(mem_win));
     if (disk_win) delwin(toWin(disk_win));
     if (diskio_win) delwin(toWin(diskio_win));
+    if (net_win) delwin(toWin(net_win));
     if (process_win) delwin(toWin(process_win));
+    if (overlay_win) delwin(toWin(overlay_win));
+    overlay_win = nullptr; // recreated, centred, on the next frame
 
-    initializeWindows();
-}
-
-static void drawHeader(WINDOW* w, const char* title) {
-    box(w, 0, 0);
-    wattron(w, COLOR_PAIR(5));
-    mvwprintw(w, 0, 2, " %s ", title);
-    wattroff(w, COLOR_PAIR(5));
+    layoutWindows();
 }
 
 // ========================= CPU PANEL =========================
-void ActivityMonitor::displayCPUInfo() {
-    WINDOW* w = toWin(cpu_win);
-    werase(w);
-    drawHeader(w, "CPU Usage");
-
-    int h, wid;
-    getmaxyx(w, h, wid);
-    (void)h;
+void ActivityMonitor::displayCPUInfo(Surface& w) {
+    int h = w.height(), wid = w.width();
 
     int legend_w = 20;
     int legend_x = std::max(2, wid - legend_w - 2);
@@ -111,7 +238,7 @@ void ActivityMonitor::displayCPUInfo() {
     int graph_h = std::max(4, h - 4);
     int graph_base = 1;
 
-    int logical_cores = (int)cpu_info.core_usage.size();
+    int logical_cores = (int)view->cpu.core_usage.size();
     int cores_avail = logical_cores;
     (void)cores_avail; // silence unused variable warning
     int legend_count = 0;
@@ -122,34 +249,57 @@ void ActivityMonitor::displayCPUInfo() {
     legend_count = std::min(8, physical_cores);
     (void)legend_count; // silence unused-variable when legend not used
 
-    // Prepare per-display-core current usage and histories (aggregate if requested)
+    // Per-display-core current usage (aggregate if requested). Histories are
+    // read straight from the per-core rings; physical cores average the two
+    // logical samples on the fly.
     std::vector<float> display_core_usage;
-    std::vector<std::vector<float>> display_cpu_history;
+    const std::vector<Span<float>>& core_hist = view->cpu_history;
+    auto logicalHist = [&](int c) { return (c < (int)core_hist.size()) ? core_hist[c] : Span<float>(); };
+    auto histLen = [&](int c) -> int {
+        if (!use_physical) return (int)logicalHist(c).size();
+        return (int)std::max(logicalHist(c * 2).size(), logicalHist(c * 2 + 1).size());
+    };
+    auto histAt = [&](int c, int j) -> float {
+        if (!use_physical) return logicalHist(c)[j];
+        Span<float> ha = logicalHist(c * 2), hb = logicalHist(c * 2 + 1);
+        float va = (j < (int)ha.size()) ? ha[j] : 0.0f;
+        float vb = (j < (int)hb.size()) ? hb[j] : 0.0f;
+        return (va + vb) / 2.0f;
+    };
     if (use_physical) {
         display_core_usage.assign(physical_cores, 0.0f);
-        display_cpu_history.assign(physical_cores, std::vector<float>());
         for (int p = 0; p < physical_cores; ++p) {
             int a = p * 2;
             int b = a + 1;
-            float ua = (a < logical_cores) ? cpu_info.core_usage[a] : 0.0f;
-            float ub = (b < logical_cores) ? cpu_info.core_usage[b] : 0.0f;
+            float ua = (a < logical_cores) ? view->cpu.core_usage[a] : 0.0f;
+            float ub = (b < logical_cores) ? view->cpu.core_usage[b] : 0.0f;
             display_core_usage[p] = (ua + ub) / 2.0f;
-            // build aggregated history by averaging corresponding samples
-            static const std::vector<float> empty_vec;
-            const std::vector<float> &ha = (a < (int)cpu_history.size()) ? cpu_history[a] : empty_vec;
-            const std::vector<float> &hb = (b < (int)cpu_history.size()) ? cpu_history[b] : empty_vec;
-            size_t maxlen = std::max(ha.size(), hb.size());
-            display_cpu_history[p].reserve(maxlen);
-            for (size_t j = 0; j < maxlen; ++j) {
-                float va = (j < ha.size()) ? ha[j] : 0.0f;
-                float vb = (j < hb.size()) ? hb[j] : 0.0f;
-                display_cpu_history[p].push_back((va + vb) / 2.0f);
-            }
         }
     } else {
-        display_core_usage = cpu_info.core_usage;
-        display_cpu_history = cpu_history;
+        display_core_usage = view->cpu.core_usage;
     }
+    Span<float> total_hist = view->total_history;
+
+    // Per-core lines exist only for raw samples; a rollup span shows the
+    // total as bucket averages with the min..max range of each bucket.
+    bool per_core = cpu_mode_per_core && history_tier < 0;
+    RollupView total_roll;
+    if (history_tier >= 0) total_roll = view->total_rollup[history_tier];
+    int total_len = (history_tier >= 0) ? (int)total_roll.size() : (int)total_hist.size();
+    auto totalAt = [&](int j) { return (history_tier >= 0) ? total_roll[j].avg : total_hist[j]; };
+
+    // Skip the panel when neither the data nor the view settings changed.
+    // Erase it only when the layout changed; the graph is diffed per column.
+    ChangeStamp layout;
+    layout.add(h).add(wid).add(per_core).add(use_physical).add(cpu_zoom_dynamic).add(history_tier).add(logical_cores);
+    bool first = !panel_valid[PanelCPU];
+    if (!panelChanged(PanelCPU, ChangeStamp(layout).add(view->cpu_stamp).h)) return;
+    if (first || layout.h != cpu_layout_key) {
+        w.erase();
+        cpu_canvas.invalidate();
+        cpu_layout_key = layout.h;
+    }
+    w.frame("CPU Usage");
 
     // Show all CPUs/cores (user requested all cores visible)
     int top_n = (int)display_core_usage.size(); // show all
@@ -164,76 +314,67 @@ void ActivityMonitor::displayCPUInfo() {
     int loy = 1;
     int lg_w = std::min(legend_w, wid - lox - 1);
     if (lg_w > 10) {
-        if (cpu_mode_per_core) {
+        if (per_core) {
             int lg_h = std::max(3, (int)plot_cores.size() + 2);
             if (!plot_cores.empty()) {
-                WINDOW* lg = derwin(w, lg_h, lg_w, 0, lox);
-                box(lg, 0, 0);
-                wattron(lg, COLOR_PAIR(5)); mvwprintw(lg, 0, 2, " CPUs "); wattroff(lg, COLOR_PAIR(5));
-                for (int i = 0; i < (int)plot_cores.size(); ++i) {
+                // legend box at (0, lox), clipped to the panel
+                lg_h = std::min(lg_h, h);
+                w.box(0, lox, lg_h, lg_w);
+                w.print(0, lox + 2, Style(5), " CPUs ");
+                for (int i = 0; i < (int)plot_cores.size() && 1 + i < lg_h - 1; ++i) {
                     int idx = plot_cores[i];
                     int colpair = 6 + (idx % 8);
                     float cur = display_core_usage[idx];
-                    wattron(lg, COLOR_PAIR(colpair) | A_BOLD);
-                        mvwaddch(lg, 1 + i, 1, ACS_BULLET);
-                    wattroff(lg, COLOR_PAIR(colpair) | A_BOLD);
-                    if (use_physical) mvwprintw(lg, 1 + i, 3, "P%-2d %5.1f%%", idx, cur);
-                    else mvwprintw(lg, 1 + i, 3, "CPU%-2d %5.1f%%", idx, cur);
+                    w.put(1 + i, lox + 1, makeCell(Glyph::Bullet, Style(colpair, AttrBold)));
+                    if (use_physical) w.print(1 + i, lox + 3, Style(), "P%-2d %5.1f%%", idx, cur);
+                    else w.print(1 + i, lox + 3, Style(), "CPU%-2d %5.1f%%", idx, cur);
                 }
-                mvwprintw(lg, std::max(1, lg_h-1), 3, "Total: %5.1f%%", cpu_info.total_usage);
-                wrefresh(lg);
-                delwin(lg);
+                w.print(std::max(1, lg_h-1), lox + 3, Style(), "Total: %5.1f%%", view->cpu.total_usage);
             }
         } else {
             int lg_h = 3;
-            WINDOW* lg = derwin(w, lg_h, lg_w, 0, lox);
-            box(lg, 0, 0);
-            wattron(lg, COLOR_PAIR(5)); mvwprintw(lg, 0, 2, " CPU Total "); wattroff(lg, COLOR_PAIR(5));
-            wattron(lg, COLOR_PAIR(11) | A_BOLD);
-            mvwaddch(lg, 1, 1, ACS_BULLET);
-            wattroff(lg, COLOR_PAIR(11) | A_BOLD);
-            mvwprintw(lg, 1, 3, "%5.1f%%", cpu_info.total_usage);
-            wrefresh(lg);
-            delwin(lg);
+            w.box(0, lox, lg_h, lg_w);
+            w.print(0, lox + 2, Style(5), " CPU Total ");
+            w.put(1, lox + 1, makeCell(Glyph::Bullet, Style(11, AttrBold)));
+            w.print(1, lox + 3, Style(), "%5.1f%%", view->cpu.total_usage);
         }
     }
 
     // Always plot, even when usage is very low. Dynamic scaling will zoom in,
     // so we don't short-circuit to an "Idle" label.
 
-    // Clear graph area (we draw only per-core dots for a clean dot-dot graph)
-    for (int gy = 0; gy < graph_h; ++gy)
-        for (int gx = 0; gx < graph_w; ++gx)
-            mvwaddch(w, graph_base + gy, graph_x + gx, ' ');
+    // Plot into the off-screen canvas; only changed columns reach the window
+    cpu_canvas.resize(graph_w, graph_h);
+    cpu_canvas.clear();
 
     // Determine Y-axis range: consider either per-core histories or total history
     float min_val = 100.0f;
     float max_val = 0.0f;
-    if (cpu_mode_per_core) {
+    if (per_core) {
         for (int pi = 0; pi < (int)plot_cores.size(); ++pi) {
             int c = plot_cores[pi];
-            const std::vector<float>& hist = (c < (int)display_cpu_history.size()) ? display_cpu_history[c] : std::vector<float>();
-            if (hist.empty()) continue;
-            int hist_len = (int)hist.size();
+            int hist_len = histLen(c);
+            if (hist_len == 0) continue;
             int samples_to_draw = std::min(graph_w, hist_len);
             for (int x = 0; x < samples_to_draw; ++x) {
                 int hist_idx = hist_len - samples_to_draw + x;
                 if (hist_idx >= 0 && hist_idx < hist_len) {
-                    float val = hist[hist_idx];
+                    float val = histAt(c, hist_idx);
                     if (val > max_val) max_val = val;
                     if (val < min_val) min_val = val;
                 }
             }
         }
     } else {
-        int hist_len = (int)total_history.size();
+        int hist_len = total_len;
         int samples_to_draw = std::min(graph_w, hist_len);
         for (int x = 0; x < samples_to_draw; ++x) {
             int hist_idx = hist_len - samples_to_draw + x;
             if (hist_idx >= 0 && hist_idx < hist_len) {
-                float val = total_history[hist_idx];
-                if (val > max_val) max_val = val;
-                if (val < min_val) min_val = val;
+                float lo = (history_tier >= 0) ? total_roll[hist_idx].min : total_hist[hist_idx];
+                float hi = (history_tier >= 0) ? total_roll[hist_idx].max : total_hist[hist_idx];
+                if (hi > max_val) max_val = hi;
+                if (lo < min_val) min_val = lo;
             }
         }
     }
@@ -261,26 +402,25 @@ void ActivityMonitor::displayCPUInfo() {
     // Subtle indicators (no numeric axis labels)
     int label_y = std::max(h - 3, graph_base + graph_h);
     if (label_y < h - 1) {
-        mvwprintw(w, label_y, graph_x, "[t] Mode: %s  |  [z] Scale: %s",
-                  cpu_mode_per_core ? "Per-core" : "Total",
-                  cpu_zoom_dynamic ? "Dyn" : "0-100");
+        w.print(label_y, graph_x, Style(), "[t] Mode: %s  |  [z] Scale: %s  |  [h] Span: %s",
+                  per_core ? "Per-core" : "Total",
+                  cpu_zoom_dynamic ? "Dyn" : "0-100",
+                  RollupHistory::tierName(history_tier));
     }
     
     // Draw graph based on mode
-    if (cpu_mode_per_core) {
+    if (per_core) {
         // Draw all cores overlapping on same graph
         for (int pi = 0; pi < (int)plot_cores.size(); ++pi) {
             int c = plot_cores[pi];
             int col = 6 + (c % 8);
-            static const std::vector<float> empty_vec2;
-            const std::vector<float>& hist = (c < (int)display_cpu_history.size()) ? display_cpu_history[c] : empty_vec2;
-            if (hist.empty()) continue;
-            int hist_len = (int)hist.size();
+            int hist_len = histLen(c);
+            if (hist_len == 0) continue;
             int samples_to_draw = std::min(graph_w, hist_len);
             for (int x = 0; x < samples_to_draw; ++x) {
                 int hist_idx = hist_len - samples_to_draw + x;
                 if (hist_idx < 0 || hist_idx >= hist_len) continue;
-                float val = hist[hist_idx];
+                float val = histAt(c, hist_idx);
                 float scaled_percent = 0.0f;
                 if (max_val > min_val) scaled_percent = ((val - min_val) / (max_val - min_val)) * 100.0f;
                 if (scaled_percent < 0.0f) scaled_percent = 0.0f;
@@ -289,20 +429,12 @@ void ActivityMonitor::displayCPUInfo() {
                 // Ensure non-zero values are at least one row high so they don't disappear on 0-100 scale
                 if (level == 0 && (val > min_val + 1e-3f)) level = 1;
                 if (level >= graph_h) level = graph_h - 1;
-                int row = graph_base + (graph_h - 1 - level);
-                wattron(w, COLOR_PAIR(col) | A_BOLD);
-                mvwaddch(w, row, graph_x + x, ACS_BULLET);
-                wattroff(w, COLOR_PAIR(col) | A_BOLD);
+                cpu_canvas.plot(x, graph_h - 1 - level, makeCell(Glyph::Bullet, Style(col, AttrBold)));
             }
         }
     } else {
         // Draw single total CPU line
-        int hist_len = (int)total_history.size();
-        int samples_to_draw = std::min(graph_w, hist_len);
-        for (int x = 0; x < samples_to_draw; ++x) {
-            int hist_idx = hist_len - samples_to_draw + x;
-            if (hist_idx < 0 || hist_idx >= hist_len) continue;
-            float val = total_history[hist_idx];
+        auto levelOf = [&](float val) {
             float scaled_percent = 0.0f;
             if (max_val > min_val) scaled_percent = ((val - min_val) / (max_val - min_val)) * 100.0f;
             if (scaled_percent < 0.0f) scaled_percent = 0.0f;
@@ -310,210 +442,347 @@ void ActivityMonitor::displayCPUInfo() {
             int level = static_cast<int>((scaled_percent / 100.0f) * (graph_h - 1) + 0.5f);
             if (level == 0 && (val > min_val + 1e-3f)) level = 1;
             if (level >= graph_h) level = graph_h - 1;
-            int row = graph_base + (graph_h - 1 - level);
-            wattron(w, COLOR_PAIR(11) | A_BOLD);
-            mvwaddch(w, row, graph_x + x, ACS_BULLET);
-            wattroff(w, COLOR_PAIR(11) | A_BOLD);
+            return level;
+        };
+        int hist_len = total_len;
+        int samples_to_draw = std::min(graph_w, hist_len);
+        for (int x = 0; x < samples_to_draw; ++x) {
+            int hist_idx = hist_len - samples_to_draw + x;
+            if (hist_idx < 0 || hist_idx >= hist_len) continue;
+            int level = levelOf(totalAt(hist_idx));
+            if (history_tier >= 0) {
+                // bucket range as a dim bar behind the average
+                int top = graph_h - 1 - levelOf(total_roll[hist_idx].max);
+                int bottom = graph_h - 1 - levelOf(total_roll[hist_idx].min);
+                for (int r = top; r <= bottom; ++r) cpu_canvas.plot(x, r, makeCell(Glyph::VLine, Style(11, AttrDim)));
+            }
+            cpu_canvas.plot(x, graph_h - 1 - level, makeCell(Glyph::Bullet, Style(11, AttrBold)));
         }
     }
 
-    wrefresh(w);
+    frame_graph_cols += cpu_canvas.flush(w, graph_base, graph_x);
+    w.stage();
 }
 
 
 
 // ========================= MEMORY PANEL =========================
-void ActivityMonitor::displayMemoryInfo() {
-    WINDOW* w = toWin(mem_win);
-    werase(w);
-    drawHeader(w, "Memory Usage");
-    int h, wid;
-    getmaxyx(w, h, wid);
-    (void)h;
-
-    // Print numeric summaries with color coding matching graph
-    wattron(w, COLOR_PAIR(4)); // cyan for Main
-    mvwprintw(w, 1, 2, "Main %3.0f%%", memory_info.percent_used); 
-    wattroff(w, COLOR_PAIR(4));
-    
-    wattron(w, COLOR_PAIR(2)); // bright yellow for Swap
-    mvwprintw(w, 2, 2, "Swap %3.0f%%", memory_info.swap_percent_used); 
-    wattroff(w, COLOR_PAIR(2));
+void ActivityMonitor::displayMemoryInfo(Surface& w) {
+    int h = w.height(), wid = w.width();
+
+    ChangeStamp layout;
+    layout.add(h).add(wid).add(history_tier).add(mem_pressure_view);
+    bool first = !panel_valid[PanelMem];
+    if (!panelChanged(PanelMem, ChangeStamp(layout).add(view->memory_stamp).h)) return;
+    if (first || layout.h != mem_layout_key) {
+        w.erase();
+        mem_canvas.invalidate();
+        mem_layout_key = layout.h;
+    }
+    w.frame(mem_pressure_view ? "Memory Pressure" : "Memory Usage");
+
+    // One line per series, raw samples or bucket averages of the selected
+    // rollup tier. Usage is in percent; pressure is in events per second.
+    struct Series {
+        Span<float> raw;
+        const RollupView* roll;
+        Cell dot;
+    };
+    Series series[3];
+    int nseries = 0;
+    auto addSeries = [&](Span<float> raw, const RollupView* tiers, Cell dot) {
+        series[nseries++] = {raw, (history_tier >= 0) ? &tiers[history_tier] : nullptr, dot};
+    };
+    const MemoryInfo& m = view->memory;
+    if (!mem_pressure_view) {
+        w.print(1, 2, Style(4), "Main %3.0f%%", m.percent_used); // cyan
+        w.print(2, 2, Style(2), "Swap %3.0f%%", m.swap_percent_used); // bright yellow
+        addSeries(view->mem_history, view->mem_rollup, makeCell(Glyph::Bullet, Style(4, AttrBold)));
+        addSeries(view->swap_history, view->swap_rollup, makeCell(Glyph::Bullet, Style(2, AttrBold)));
+    } else {
+        auto rate = [](float r) {
+            char buf[16];
+            if (r >= 1000000.0f) snprintf(buf, sizeof(buf), "%.1fM", r / 1000000.0f);
+            else if (r >= 1000.0f) snprintf(buf, sizeof(buf), "%.1fK", r / 1000.0f);
+            else snprintf(buf, sizeof(buf), "%.0f", r);
+            return std::string(buf);
+        };
+        int x = w.print(1, 2, Style(4), "Major faults %s/s", rate(m.major_faults_per_sec).c_str()); // cyan
+        w.print(1, x, Style(), "  minor %s/s", rate(m.minor_faults_per_sec).c_str());
+        x = w.print(2, 2, Style(2), "Swap in %s out %s pg/s", rate(m.swap_in_per_sec).c_str(),
+                    rate(m.swap_out_per_sec).c_str()); // bright yellow
+        w.print(2, x, Style(10), "  Refaults %s/s", rate(m.refaults_per_sec).c_str()); // red
+        x = w.print(3, 2, Style(), "Reclaim scan %s steal %s pg/s", rate(m.pgscan_per_sec).c_str(),
+                    rate(m.pgsteal_per_sec).c_str());
+        if (m.cache_effectiveness < 0) w.print(3, x, Style(), "  Cache -");
+        else w.print(3, x, Style(m.cache_effectiveness < 50.0f ? 3 : 0), "  Cache %.0f%%", m.cache_effectiveness);
+        addSeries(view->majflt_history, view->majflt_rollup, makeCell(Glyph::Bullet, Style(4, AttrBold)));
+        addSeries(view->swapio_history, view->swapio_rollup, makeCell(Glyph::Bullet, Style(2, AttrBold)));
+        addSeries(view->refault_history, view->refault_rollup, makeCell(Glyph::Bullet, Style(10, AttrBold)));
+    }
+    if (wid > 30) w.print(1, wid - 12, Style(), "Span: %-4s", RollupHistory::tierName(history_tier));
 
     // Draw continuous smooth line graph like the reference image
     int graph_y = 4;
     int graph_h = std::max(3, h - graph_y - 1);
     int graph_w = std::max(10, wid - 6);
-    
+
     // Use absolute positioning - map latest samples to rightmost columns
-    int mem_len = (int)mem_history.size();
-    int swap_len = (int)swap_history.size();
-    int samples = std::min(graph_w, std::max(mem_len, swap_len));
+    auto len = [](const Series& s) { return s.roll ? (int)s.roll->size() : (int)s.raw.size(); };
+    auto at = [](const Series& s, int j) { return s.roll ? (*s.roll)[j].avg : s.raw[j]; };
+    int samples = 0;
+    for (int i = 0; i < nseries; ++i) samples = std::max(samples, len(series[i]));
+    samples = std::min(graph_w, samples);
 
-    // clear graph area
-    for (int gy = 0; gy < graph_h; ++gy)
-        for (int gx = 0; gx < graph_w; ++gx)
-            mvwaddch(w, graph_y + gy, 2 + gx, ' ');
+    mem_canvas.resize(graph_w, graph_h);
+    mem_canvas.clear();
 
-    // Find max value to scale graph properly so both lines are visible
+    // Find max value to scale graph properly so all lines are visible
     float max_val = 10.0f; // minimum scale
-    for (int x = 0; x < samples; ++x) {
-        int mem_idx = mem_len - samples + x;
-        int swap_idx = swap_len - samples + x;
-        if (mem_idx >= 0 && mem_idx < mem_len) {
-            if (mem_history[mem_idx] > max_val) max_val = mem_history[mem_idx];
-        }
-        if (swap_idx >= 0 && swap_idx < swap_len) {
-            if (swap_history[swap_idx] > max_val) max_val = swap_history[swap_idx];
-        }
+    for (int i = 0; i < nseries; ++i) {
+        int n = len(series[i]);
+        for (int j = std::max(0, n - samples); j < n; ++j) max_val = std::max(max_val, at(series[i], j));
     }
-    if (max_val < 10.0f) max_val = 10.0f;
-    if (max_val > 100.0f) max_val = 100.0f;
+    if (!mem_pressure_view && max_val > 100.0f) max_val = 100.0f;
 
     // Draw continuous lines with dots
-    for (int x = 0; x < samples; ++x) {
-        int mem_idx = mem_len - samples + x;
-        int swap_idx = swap_len - samples + x;
-        
-        // Main memory line (cyan dots)
-        if (mem_idx >= 0 && mem_idx < mem_len) {
-            float mv = mem_history[mem_idx];
-            int mlevel = static_cast<int>((mv / max_val) * (graph_h - 1) + 0.5f);
-            if (mlevel >= graph_h) mlevel = graph_h - 1;
-            int mrow = graph_y + (graph_h - 1 - mlevel);
-            wattron(w, COLOR_PAIR(4) | A_BOLD); // cyan
-            mvwaddch(w, mrow, 2 + x, ACS_BULLET);
-            wattroff(w, COLOR_PAIR(4) | A_BOLD);
-        }
-
-        // Swap memory line (yellow dots)
-        if (swap_idx >= 0 && swap_idx < swap_len) {
-            float sv = swap_history[swap_idx];
-            int slevel = static_cast<int>((sv / max_val) * (graph_h - 1) + 0.5f);
-            if (slevel >= graph_h) slevel = graph_h - 1;
-            int srow = graph_y + (graph_h - 1 - slevel);
-            wattron(w, COLOR_PAIR(2) | A_BOLD); // yellow
-            mvwaddch(w, srow, 2 + x, ACS_BULLET); // Changed from ACS_DIAMOND to ACS_BULLET
-            wattroff(w, COLOR_PAIR(2) | A_BOLD);
+    for (int i = 0; i < nseries; ++i) {
+        int n = len(series[i]);
+        for (int x = 0; x < samples; ++x) {
+            int j = n - samples + x;
+            if (j < 0 || j >= n) continue;
+            int level = static_cast<int>((at(series[i], j) / max_val) * (graph_h - 1) + 0.5f);
+            if (level >= graph_h) level = graph_h - 1;
+            mem_canvas.plot(x, graph_h - 1 - level, series[i].dot);
         }
     }
-    wrefresh(w);
+    frame_graph_cols += mem_canvas.flush(w, graph_y, 2);
+    w.stage();
 }
 
 // ========================= DISK PANEL =========================
-void ActivityMonitor::displayDiskInfo() {
-    WINDOW* w = toWin(disk_win);
-    werase(w);
-    drawHeader(w, "Disk Usage");
-    int h, wid;
-    getmaxyx(w, h, wid);
-    // responsive column widths based on window width
+void ActivityMonitor::displayDiskInfo(Surface& w) {
+    if (!panelChanged(PanelDisk, view->disks_stamp)) return;
+    w.erase();
+    w.frame("Disk Usage");
+    int h = w.height(), wid = w.width();
+    // responsive column widths based on window width; a narrow panel
+    // shows only the mount point and free space
     int col1 = std::min(20, std::max(8, wid / 6));
     int col2 = std::min(30, std::max(10, wid / 3));
-    int rem = wid - 6 - col1 - col2; if (rem < 20) rem = 20;
+    int rem = wid - 6 - col1 - col2;
+    bool narrow = rem < 20;
+    if (narrow) {
+        rem = 10;
+        col2 = std::max(1, wid - 5 - rem);
+    }
     int col3 = rem / 2;
-    int col4 = rem - col3;
+    int col4 = narrow ? rem : rem - col3;
 
-    mvwprintw(w, 1, 2, "%-*s %-*s %*s %*s", col1, "Disk", col2, "Mount", col3, "Used", col4, "Free");
+    if (narrow) w.print(1, 2, Style(), "%-*s %*s", col2, "Mount", col4, "Free");
+    else w.print(1, 2, Style(), "%-*s %-*s %*s %*s", col1, "Disk", col2, "Mount", col3, "Used", col4, "Free");
     int row = 2;
-    for (const auto& d : disk_info) {
+    for (const auto& d : view->disks) {
         if (row >= h - 1) break;
         unsigned long long used = d.used_space;
         std::string dev = d.device;
         std::string mnt = d.mount_point;
         if ((int)dev.size() > col1) dev = dev.substr(0, col1-3) + "...";
         if ((int)mnt.size() > col2) mnt = mnt.substr(0, col2-3) + "...";
-        std::string used_s = formatSize(used);
-        std::string free_s = formatSize(d.free_space);
-        mvwprintw(w, row, 2, "%-*s %-*s %*s %*s", col1, dev.c_str(), col2, mnt.c_str(), col3, used_s.c_str(), col4, free_s.c_str());
+        std::string used_s = (d.stalled && d.total_space == 0) ? "-" : formatSize(used);
+        std::string free_s = d.stalled ? "stalled" : formatSize(d.free_space);
+        if (narrow) w.print(row, 2, Style(d.stalled ? 2 : 0), "%-*s %*s", col2, mnt.c_str(), col4, free_s.c_str());
+        else w.print(row, 2, Style(d.stalled ? 2 : 0), "%-*s %-*s %*s %*s", col1, dev.c_str(), col2, mnt.c_str(), col3, used_s.c_str(), col4, free_s.c_str());
         row++;
     }
-    wrefresh(w);
+    w.stage();
 }
 
 // ========================= NETWORK PANEL =========================
+// One-row sparkline of the newest `cols` samples of a (plus b, if given;
+// both must come from rings pushed together), scaled to the peak but to
+// no less than `floor`
+static void drawSparkline(Surface& w, int y, int x, int cols, Span<float> a, Span<float> b, float floor, Style st) {
+    static const char kRamp[] = " .:-=+*#";
+    cols = std::min(cols, (int)a.size());
+    if (!b.empty()) cols = std::min(cols, (int)b.size());
+    if (cols <= 0) return;
+    auto value = [&](int i) {
+        float v = a[a.size() - cols + i];
+        if (!b.empty()) v += b[b.size() - cols + i];
+        return v;
+    };
+    float peak = floor;
+    for (int i = 0; i < cols; ++i) peak = std::max(peak, value(i));
+    for (int i = 0; i < cols; ++i) {
+        int level = std::min(7, (int)(value(i) / peak * 7.0f + 0.5f));
+        w.put(y, x + i, makeCell(kRamp[level], st));
+    }
+}
+
+void ActivityMonitor::displayNetInfo(Surface& w) {
+    if (!panelChanged(PanelNet, view->net_stamp)) return;
+    w.erase();
+    w.frame("Network");
+    const NetInfo& net = view->net;
+    int h = w.height(), wid = w.width();
+
+    int inner = wid - 4;
+    bool wide = inner >= 33;
+    if (wide) {
+        w.print(1, 2, Style(), "RX: %8.2f MB/s %8.0f pkt/s", net.rx_mb_per_sec, net.rx_packets_per_sec);
+        w.print(2, 2, Style(), "TX: %8.2f MB/s %8.0f pkt/s", net.tx_mb_per_sec, net.tx_packets_per_sec);
+    } else {
+        w.print(1, 2, Style(), "RX: %7.2f MB/s", net.rx_mb_per_sec);
+        w.print(2, 2, Style(), "TX: %7.2f MB/s", net.tx_mb_per_sec);
+    }
+    int x = w.print(3, 2, Style(net.drops_per_sec > 0 ? 2 : 0), wide ? "Drops: %.0f/s" : "Drp: %.0f", net.drops_per_sec);
+    w.print(3, x + 1, Style(net.errors_per_sec > 0 ? 3 : 0), wide ? " Errors: %.0f/s" : "Err: %.0f", net.errors_per_sec);
+
+    // Per-interface table. Narrow panels drop the packet rates, then the
+    // drop/error count and the link utilisation, then shorten the names;
+    // the rest of a wide row is a sparkline of rx + tx. Interfaces left out
+    // of the totals are dimmed.
+    const int kBase = 8 + 16; // interface, rx and tx
+    bool show_util = inner >= kBase + 6;
+    bool show_drops = inner >= kBase + 6 + 7;
+    bool show_pkts = inner >= kBase + 6 + 7 + 16;
+    int name_w = std::max(4, std::min(8, inner - 16));
+    int used = name_w + 16 + (show_util ? 6 : 0) + (show_drops ? 7 : 0) + (show_pkts ? 16 : 0);
+    int spark_w = inner - used - 1;
+    if (spark_w < 4) spark_w = 0;
+
+    int rows = std::max(0, std::min((int)net.interfaces.size(), h - 6));
+    int col = w.print(4, 2, Style(0, AttrBold), "%-*s %7s %7s", name_w, name_w >= 5 ? "Iface" : "If", "rxMB/s", "txMB/s");
+    if (show_pkts) col = w.print(4, col, Style(0, AttrBold), " %7s %7s", "rxpk/s", "txpk/s");
+    if (show_drops) col = w.print(4, col, Style(0, AttrBold), " %6s", "drp+er");
+    if (show_util) w.print(4, col, Style(0, AttrBold), " %5s", "util");
+    for (int i = 0; i < rows; ++i) {
+        const NetInterfaceIO& n = net.interfaces[i];
+        Style st(0, n.in_totals ? 0 : AttrDim);
+        int y = 5 + i;
+        std::string name = n.name.substr(0, name_w);
+        col = w.print(y, 2, st, "%-*s %7.2f %7.2f", name_w, name.c_str(), n.rx_mb_per_sec, n.tx_mb_per_sec);
+        if (show_pkts) col = w.print(y, col, st, " %7.0f %7.0f", n.rx_packets_per_sec, n.tx_packets_per_sec);
+        if (show_drops) {
+            float bad = n.drops_per_sec + n.errors_per_sec;
+            col = w.print(y, col, bad > 0 ? Style(3) : st, " %6.0f", bad);
+        }
+        if (show_util) {
+            if (n.util_percent < 0) col = w.print(y, col, st, " %5s", "-");
+            else col = w.print(y, col, Style(n.util_percent >= 80.0f ? 3 : n.util_percent >= 50.0f ? 2 : 0), " %4.0f%%", n.util_percent);
+        }
+        if (spark_w) drawSparkline(w, y, 2 + used + 1, spark_w, n.rx_history, n.tx_history, 0.1f, Style(4));
+    }
+    w.stage();
+}
+
 // ========================= DISK I/O PANEL =========================
-void ActivityMonitor::displayDiskIOInfo() {
-    WINDOW* w = toWin(diskio_win);
-    werase(w);
-    drawHeader(w, "Disk I/O");
-    int h, wid;
-    getmaxyx(w, h, wid);
-    (void)h;
+void ActivityMonitor::displayDiskIOInfo(Surface& w) {
+    if (!panelChanged(PanelDiskIO, ChangeStamp().add(view->diskio_stamp).add(history_tier).h)) return;
+    w.erase();
+    w.frame("Disk I/O");
+    int wid = w.width();
 
     // Display current I/O rates
-    mvwprintw(w, 1, 2, "Read:  %7.1f MB/s", diskio_info.read_mb_per_sec);
-    mvwprintw(w, 2, 2, "Write: %7.1f MB/s", diskio_info.write_mb_per_sec);
+    w.print(1, 2, Style(), "Read:  %7.1f MB/s", view->diskio.read_mb_per_sec);
+    w.print(2, 2, Style(), "Write: %7.1f MB/s", view->diskio.write_mb_per_sec);
     
-    mvwprintw(w, 1, 24, "| %7.0f ops/s", diskio_info.read_ops_per_sec);
-    mvwprintw(w, 2, 24, "| %7.0f ops/s", diskio_info.write_ops_per_sec);
+    w.print(1, 24, Style(), "| %7.0f ops/s", view->diskio.read_ops_per_sec);
+    w.print(2, 24, Style(), "| %7.0f ops/s", view->diskio.write_ops_per_sec);
     
     // I/O busy percentage
     int busy_color = 1; // green
-    if (diskio_info.io_busy_percent >= 80.0f) busy_color = 3; // red
-    else if (diskio_info.io_busy_percent >= 50.0f) busy_color = 2; // yellow
+    if (view->diskio.io_busy_percent >= 80.0f) busy_color = 3; // red
+    else if (view->diskio.io_busy_percent >= 50.0f) busy_color = 2; // yellow
     
-    wattron(w, COLOR_PAIR(busy_color));
-    mvwprintw(w, 4, 2, "Busy: %5.1f%%", diskio_info.io_busy_percent);
-    wattroff(w, COLOR_PAIR(busy_color));
+    w.print(3, 2, Style(busy_color), "Busy: %5.1f%%", view->diskio.io_busy_percent);
+
+    // Per-disk table. Narrow panels drop the queue depth, await and mount
+    // columns, in that order. Disks left out of the totals are dimmed.
+    int h = w.height();
+    int inner = wid - 4;
+    const int kBase = 8 + 15 + 6; // device, read and write, util
+    bool show_await = inner >= kBase + 8;
+    bool show_qd = inner >= kBase + 8 + 6;
+    int mount_w = inner - kBase - (show_await ? 8 : 0) - (show_qd ? 6 : 0) - 1;
+    if (mount_w < 6) mount_w = 0;
+    mount_w = std::min(mount_w, 20);
+
+    int rows = std::max(0, std::min((int)view->diskio.devices.size(), h - 6));
+    int col = w.print(4, 2, Style(0, AttrBold), "%-7s ", "Device");
+    if (mount_w) col = w.print(4, col, Style(0, AttrBold), "%-*s ", mount_w, "Mount");
+    col = w.print(4, col, Style(0, AttrBold), "%7s %7s", "rMB/s", "wMB/s");
+    if (show_await) col = w.print(4, col, Style(0, AttrBold), " %7s", "await");
+    if (show_qd) col = w.print(4, col, Style(0, AttrBold), " %5s", "qd");
+    w.print(4, col, Style(0, AttrBold), " %5s", "util");
+    for (int i = 0; i < rows; ++i) {
+        const DiskDeviceIO& d = view->diskio.devices[i];
+        Style st(0, d.in_totals ? 0 : AttrDim);
+        int y = 5 + i;
+        std::string name = d.name.substr(0, 7);
+        std::string mnt = d.mount_point;
+        if ((int)mnt.size() > mount_w) mnt = mount_w > 3 ? "..." + mnt.substr(mnt.size() - (mount_w - 3)) : "";
+        col = w.print(y, 2, st, "%-7s ", name.c_str());
+        if (mount_w) col = w.print(y, col, st, "%-*s ", mount_w, mnt.c_str());
+        col = w.print(y, col, st, "%7.1f %7.1f", d.read_mb_per_sec, d.write_mb_per_sec);
+        if (show_await) {
+            if (d.await_ms < 0) col = w.print(y, col, st, " %7s", "-");
+            else col = w.print(y, col, st, " %5.1fms", d.await_ms);
+        }
+        if (show_qd) col = w.print(y, col, st, " %5.2f", d.queue_depth);
+        w.print(y, col, st, " %4.0f%%", d.util_percent);
+    }
 
-    // Draw horizontal bar graphs for read and write
-    int bar_y_read = 5;
-    int bar_y_write = 6;
+    // Read and write bars along the bottom when the table leaves room
+    int bar_y_read = 5 + rows + 1;
+    int bar_y_write = bar_y_read + 1;
+    if (bar_y_write > h - 2) {
+        w.stage();
+        return;
+    }
     int bar_w = std::max(20, wid - 4);
     
-    // Find max for scaling
+    // Find max for scaling, over the selected graph span
     float max_rate = 10.0f; // minimum 10 MB/s scale
-    for (float v : diskio_read_history) if (v > max_rate) max_rate = v;
-    for (float v : diskio_write_history) if (v > max_rate) max_rate = v;
+    if (history_tier >= 0) {
+        const RollupView& rd = view->diskio_read_rollup[history_tier];
+        const RollupView& wr = view->diskio_write_rollup[history_tier];
+        for (size_t i = 0; i < rd.size(); ++i) if (rd[i].max > max_rate) max_rate = rd[i].max;
+        for (size_t i = 0; i < wr.size(); ++i) if (wr[i].max > max_rate) max_rate = wr[i].max;
+    } else {
+        for (float v : view->diskio_read_history) if (v > max_rate) max_rate = v;
+        for (float v : view->diskio_write_history) if (v > max_rate) max_rate = v;
+    }
     
     // Compute fill widths
-    float read_pct = std::min(100.0f, (diskio_info.read_mb_per_sec / max_rate) * 100.0f);
-    float write_pct = std::min(100.0f, (diskio_info.write_mb_per_sec / max_rate) * 100.0f);
+    float read_pct = std::min(100.0f, (view->diskio.read_mb_per_sec / max_rate) * 100.0f);
+    float write_pct = std::min(100.0f, (view->diskio.write_mb_per_sec / max_rate) * 100.0f);
     int read_fill = static_cast<int>((bar_w * read_pct / 100.0f) + 0.5f);
     int write_fill = static_cast<int>((bar_w * write_pct / 100.0f) + 0.5f);
     
     // Draw Read bar (cyan)
-    for (int x = 0; x < bar_w; ++x) {
-        if (x < read_fill) {
-            wattron(w, COLOR_PAIR(4) | A_BOLD);
-            mvwaddch(w, bar_y_read, 2 + x, ACS_CKBOARD);
-            wattroff(w, COLOR_PAIR(4) | A_BOLD);
-        } else {
-            mvwaddch(w, bar_y_read, 2 + x, ' ');
-        }
-    }
+    for (int x = 0; x < bar_w; ++x)
+        w.put(bar_y_read, 2 + x, (x < read_fill) ? makeCell(Glyph::Checkerboard, Style(4, AttrBold)) : makeCell(' '));
     
     // Draw Write bar (red)
-    for (int x = 0; x < bar_w; ++x) {
-        if (x < write_fill) {
-            wattron(w, COLOR_PAIR(10) | A_BOLD);
-            mvwaddch(w, bar_y_write, 2 + x, ACS_CKBOARD);
-            wattroff(w, COLOR_PAIR(10) | A_BOLD);
-        } else {
-            mvwaddch(w, bar_y_write, 2 + x, ' ');
-        }
-    }
+    for (int x = 0; x < bar_w; ++x)
+        w.put(bar_y_write, 2 + x, (x < write_fill) ? makeCell(Glyph::Checkerboard, Style(10, AttrBold)) : makeCell(' '));
 
-    wrefresh(w);
+    w.stage();
 }
 
 // ========================= TEMPERATURE PANEL =========================
 // ========================= SYSTEM INFO PANEL =========================
-void ActivityMonitor::displaySystemInfo() {
-    WINDOW* w = toWin(sysinfo_win);
-    if (!w) return;
-    werase(w);
-    drawHeader(w, "System Info");
-
-    int h, wid;
-    getmaxyx(w, h, wid);
-    (void)h;
+void ActivityMonitor::displaySystemInfo(Surface& w) {
+    if (!panelChanged(PanelSysInfo, ChangeStamp().add(view->system_stamp).add(view->cpu.num_cores).h)) return;
+    w.erase();
+    w.frame("System Info");
     
     // Format uptime
-    int days = (int)(system_info.uptime_seconds / 86400);
-    int hours = (int)((system_info.uptime_seconds - days * 86400) / 3600);
-    int mins = (int)((system_info.uptime_seconds - days * 86400 - hours * 3600) / 60);
+    int days = (int)(view->system.uptime_seconds / 86400);
+    int hours = (int)((view->system.uptime_seconds - days * 86400) / 3600);
+    int mins = (int)((view->system.uptime_seconds - days * 86400 - hours * 3600) / 60);
     
     char uptime_str[64];
     if (days > 0) {
@@ -525,7 +794,7 @@ void ActivityMonitor::displaySystemInfo() {
     }
 
     // Determine load color based on number of cores
-    int cores = cpu_info.num_cores;
+    int cores = view->cpu.num_cores;
     if (cores == 0) cores = 1;
     
     auto getLoadColor = [cores](float load) -> int {
@@ -535,9 +804,9 @@ void ActivityMonitor::displaySystemInfo() {
         return 1; // green (normal)
     };
     
-    int load_color_1 = getLoadColor(system_info.load_1min);
-    (void)getLoadColor(system_info.load_5min);   // Suppress unused warning
-    (void)getLoadColor(system_info.load_15min);  // Suppress unused warning
+    int load_color_1 = getLoadColor(view->system.load_1min);
+    (void)getLoadColor(view->system.load_5min);   // Suppress unused warning
+    (void)getLoadColor(view->system.load_15min);  // Suppress unused warning
 
     // Format rate helper
     auto formatRate = [](float rate) -> std::string {
@@ -557,46 +826,61 @@ void ActivityMonitor::displaySystemInfo() {
     };
 
     // Line 1: Uptime
-    mvwprintw(w, 1, 2, "Uptime: %s", uptime_str);
+    w.print(1, 2, Style(), "Uptime: %s", uptime_str);
     
     // Line 2: Load (1m)
-    mvwprintw(w, 2, 2, "Load (1m): ");
-    wattron(w, COLOR_PAIR(load_color_1));
-    wprintw(w, "%.2f", system_info.load_1min);
-    wattroff(w, COLOR_PAIR(load_color_1));
+    int x = w.print(2, 2, "Load (1m): ");
+    w.print(2, x, Style(load_color_1), "%.2f", view->system.load_1min);
 
     // Line 3: Interrupts
-    mvwprintw(w, 3, 2, "Interrupts: ");
-    wattron(w, COLOR_PAIR(9)); // yellow
-    wprintw(w, "%s", formatRate(system_info.interrupts_per_sec).c_str());
-    wattroff(w, COLOR_PAIR(9));
+    x = w.print(3, 2, "Interrupts: ");
+    w.print(3, x, Style(9), "%s", formatRate(view->system.interrupts_per_sec).c_str()); // yellow
 
     // Line 4: Context switches
-    mvwprintw(w, 4, 2, "Context Switches: ");
-    wattron(w, COLOR_PAIR(4)); // cyan
-    wprintw(w, "%s", formatRate(system_info.ctx_switches_per_sec).c_str());
-    wattroff(w, COLOR_PAIR(4));
+    x = w.print(4, 2, "Context Switches: ");
+    w.print(4, x, Style(4), "%s", formatRate(view->system.ctx_switches_per_sec).c_str()); // cyan
+
+    // Line 5: Runnable / blocked tasks
+    w.print(5, 2, Style(), "Tasks: %llu running, %llu blocked",
+            view->system.procs_running, view->system.procs_blocked);
+
+    // Line 6: Process creation rate
+    w.print(6, 2, Style(), "Forks: %s", formatRate(view->system.forks_per_sec).c_str());
+
+    // Lines 7+: pressure stall averages (some and full, 10s/60s) and a
+    // sparkline of "some" avg10, as many resources as fit
+    if (view->pressure.available) {
+        for (int r = 0; r < PsiResourceCount && 7 + r < w.height() - 1; ++r) {
+            const PsiResource& p = view->pressure.resource[r];
+            int color = (p.some.avg10 >= 40.0f) ? 3 : (p.some.avg10 >= 10.0f) ? 2 : 0;
+            int y = 7 + r;
+            x = w.print(y, 2, Style(color), "PSI %-6s %5.1f %5.1f", psiResourceName(r), p.some.avg10, p.some.avg60);
+            if (p.has_full) x = w.print(y, x, Style(), "  full %5.1f %5.1f", p.full.avg10, p.full.avg60);
+            // scaled to at least 10%, so quiet histories stay flat
+            drawSparkline(w, y, x + 1, w.width() - 2 - (x + 1), view->psi_some_history[r], Span<float>(), 10.0f, Style(color));
+        }
+    }
 
-    wrefresh(w);
+    w.stage();
 }
 
 // ========================= PROCESS PANEL =========================
-void ActivityMonitor::displayProcessInfo() {
-    WINDOW* w = toWin(process_win);
-    werase(w);
-    drawHeader(w, "Processes (q=quit, k=kill, /=search, c=sort CPU, m=sort mem)");
-
-    int h, wid;
-    getmaxyx(w, h, wid);
+void ActivityMonitor::displayProcessInfo(Surface& w) {
+    ChangeStamp key;
+    key.add(view->processes_stamp).add(search_mode).add(search_query)
+       .add(process_selected).add(process_list_offset);
+    if (!panelChanged(PanelProcess, key.h)) return;
+    w.erase();
+    w.frame("Processes (q=quit, k=kill, i=info, /=search, c=sort CPU, m=sort mem)");
+
+    int h = w.height(), wid = w.width();
     
     // Display search bar
     int header_line = 1;
     if (search_mode || !search_query.empty()) {
-        wattron(w, COLOR_PAIR(search_mode ? 6 : 4));
-        mvwprintw(w, header_line, 2, "Search: %s%s", search_query.c_str(), search_mode ? "_" : "");
-        wattroff(w, COLOR_PAIR(search_mode ? 6 : 4));
+        w.print(header_line, 2, Style(search_mode ? 6 : 4), "Search: %s%s", search_query.c_str(), search_mode ? "_" : "");
         if (!search_mode && !search_query.empty()) {
-            mvwprintw(w, header_line, 2 + 8 + (int)search_query.size() + 5, "(ESC to clear)");
+            w.print(header_line, 2 + 8 + (int)search_query.size() + 5, "(ESC to clear)");
         }
         header_line++;
     }
@@ -607,7 +891,7 @@ void ActivityMonitor::displayProcessInfo() {
         std::string query_lower = search_query;
         std::transform(query_lower.begin(), query_lower.end(), query_lower.begin(), ::tolower);
         
-        for (const auto& p : processes) {
+        for (const auto& p : view->processes) {
             std::string name_lower = p.name;
             std::transform(name_lower.begin(), name_lower.end(), name_lower.begin(), ::tolower);
             if (name_lower.find(query_lower) != std::string::npos) {
@@ -617,9 +901,11 @@ void ActivityMonitor::displayProcessInfo() {
     }
     
     // Choose which process list to display
-    auto& proc_list = search_query.empty() ? processes : filtered_processes;
+    const auto& proc_list = search_query.empty() ? view->processes : filtered_processes;
+    // the list may have shrunk since the last snapshot
+    if (process_selected >= (int)proc_list.size()) process_selected = std::max(0, (int)proc_list.size() - 1);
     
-    mvwprintw(w, header_line, 2, "%-6s %-25s %-8s %-8s", "PID", "Name", "CPU%", "Mem%");
+    w.print(header_line, 2, Style(), "%-6s %-25s %-8s %-8s", "PID", "Name", "CPU%", "Mem%");
     header_line++;
 
     int rows = h - header_line - 2;
@@ -628,32 +914,76 @@ void ActivityMonitor::displayProcessInfo() {
     for (int i = 0; i < rows && index < (int)proc_list.size(); ++i, ++index) {
         const Process& p = proc_list[index];
         int abs_idx = index;
-        if (abs_idx == process_selected) wattron(w, A_REVERSE);
-        mvwprintw(w, header_line + i, 2, "%-6d %-25s %7.1f %7.1f",
-                  p.pid, p.name.c_str(), p.cpu_percent, p.mem_percent);
-        if (abs_idx == process_selected) wattroff(w, A_REVERSE);
+        w.print(header_line + i, 2, Style(0, abs_idx == process_selected ? AttrReverse : 0), "%-6d %-25s %7.1f %7.1f",
+                p.pid, p.name.c_str(), p.cpu_percent, p.mem_percent);
     }
 
     if ((int)proc_list.size() > rows) {
-        mvwprintw(w, h - 1, wid - 20, "Showing %d/%zu", rows, proc_list.size());
+        w.print(h - 1, wid - 20, Style(), "Showing %d/%zu", rows, proc_list.size());
     }
     
     // Show match count if searching
     if (!search_query.empty()) {
-        mvwprintw(w, h - 1, 2, "Matches: %zu", filtered_processes.size());
+        w.print(h - 1, 2, Style(), "Matches: %zu", filtered_processes.size());
     }
     
-    wrefresh(w);
+    w.stage();
+}
+
+// ========================= OVERHEAD OVERLAY =========================
+void ActivityMonitor::displayOverlay(Surface& w) {
+    std::vector<std::string> lines;
+    overheadReport(view->overhead, lines);
+    w.erase();
+    w.frame("Monitor overhead (o to close)");
+    for (int i = 0; i < (int)lines.size() && i + 1 < w.height() - 1; ++i)
+        w.text(1 + i, 2, lines[i].data(), std::min(lines[i].size(), (size_t)std::max(0, w.width() - 4)), Style());
+    w.stage();
 }
 
 // ========================= ALERT PANEL =========================
 void ActivityMonitor::displayAlert() {
-    if (!config.show_alert) return;
-    if (cpu_info.total_usage <= config.cpu_threshold) return;
     int y = 0;
     int x = terminal_width - 40;
-    mvprintw(y, x, "!!! CPU USAGE HIGH: %.1f%% !!!", cpu_info.total_usage);
-    refresh();
+    bool shown = false;
+    if (replay) {
+        // after the CPU panel title; alerts may cover its end on narrow terminals
+        attron(A_BOLD);
+        mvprintw(y, 16, "%-36s", replayStatus().c_str());
+        attroff(A_BOLD);
+        shown = true;
+    }
+    if (config.show_alert && view->cpu.total_usage > config.cpu_threshold) {
+        mvprintw(y, x, "!!! CPU USAGE HIGH: %.1f%% !!!", view->cpu.total_usage);
+        shown = true;
+    }
+    // a PSI trigger fired recently; placed left of the CPU alert
+    if (!psi_alert.empty()) {
+        int len = (int)psi_alert.size() + 8;
+        int px = shown ? x - len - 1 : terminal_width - len - 2;
+        attron(COLOR_PAIR(3) | A_BOLD);
+        mvprintw(y, std::max(0, px), "!!! %s !!!", psi_alert.c_str());
+        attroff(COLOR_PAIR(3) | A_BOLD);
+        shown = true;
+    }
+    if (shown) wnoutrefresh(stdscr);
+}
+
+// Register the --psi-trigger thresholds; a trigger the kernel refuses is fatal
+void ActivityMonitor::openPsiTriggers() {
+    for (const PsiTriggerSpec& spec : config.psi_triggers) {
+        int fd = openPsiTrigger(spec);
+        if (fd < 0)
+            throw std::runtime_error("Failed to register PSI trigger " + describePsiTrigger(spec) + ": " + strerror(errno));
+        psi_trigger_fds.push_back(fd);
+    }
+}
+
+void ActivityMonitor::onPsiTrigger(size_t index) {
+    const PsiTriggerSpec& spec = config.psi_triggers[index];
+    psi_alert = "PSI " + describePsiTrigger(spec);
+    psi_alert_until_ns = monotonicNs() + 5000000000ULL;
+    if (config.debug_mode) debugLog("PSI trigger fired: " + describePsiTrigger(spec));
 }
 
 // ========================= CONFIRMATION DIALOG =========================
@@ -674,6 +1004,7 @@ bool ActivityMonitor::displayConfirmationDialog(const std::string& message) {
 
     int ch = wgetch(d);
     delwin(d);
+    invalidatePanels(); // the dialog left its cells on screen
     return (ch == 'y' || ch == 'Y');
 }
 
@@ -691,36 +1022,147 @@ void ActivityMonitor::displayMessage(const std::string& message) {
     wrefresh(d);
     wgetch(d);
     delwin(d);
+    invalidatePanels();
+}
+
+// Process detail dialog; the data is read from /proc/<pid>/status only here
+void ActivityMonitor::displayProcessDetails(int pid) {
+    ProcessDetails d;
+    if (!readProcessDetails(pid, d)) {
+        displayMessage("Process " + std::to_string(pid) + " is no longer running.");
+        return;
+    }
+    int h = 12;
+    int w = std::min(60, terminal_width - 4);
+    int sy = std::max(0, (terminal_height - h) / 2);
+    int sx = std::max(0, (terminal_width - w) / 2);
+    WINDOW* dw = newwin(h, w, sy, sx);
+    box(dw, 0, 0);
+    wattron(dw, COLOR_PAIR(5)); mvwprintw(dw, 0, 2, " Process %d ", pid); wattroff(dw, COLOR_PAIR(5));
+    mvwprintw(dw, 1, 2, "Name:    %s", d.name.c_str());
+    mvwprintw(dw, 2, 2, "State:   %s", d.state.c_str());
+    mvwprintw(dw, 3, 2, "PPID:    %d   UID: %d", d.ppid, d.uid);
+    mvwprintw(dw, 4, 2, "Threads: %d", d.threads);
+    mvwprintw(dw, 5, 2, "VmSize:  %s", formatSize(d.vm_size_kb).c_str());
+    mvwprintw(dw, 6, 2, "VmRSS:   %s", formatSize(d.vm_rss_kb).c_str());
+    mvwprintw(dw, 7, 2, "VmSwap:  %s", formatSize(d.vm_swap_kb).c_str());
+    mvwprintw(dw, 8, 2, "Ctx switches: %llu vol / %llu invol",
+              d.voluntary_ctxt_switches, d.nonvoluntary_ctxt_switches);
+    mvwprintw(dw, 10, 2, "Press any key to continue");
+    wrefresh(dw);
+    wgetch(dw);
+    delwin(dw);
+    invalidatePanels();
 }
 
 // ========================= MAIN LOOP =========================
 void ActivityMonitor::run() {
+    if (!replay) openPsiTriggers(); // a replay shows the recorded system, not this one
     initializeWindows();
-    collectData();
-
+    nodelay(stdscr, TRUE);
+
+    // SIGWINCH was blocked in the constructor; receive it as an fd
+    sigset_t winch;
+    sigemptyset(&winch);
+    sigaddset(&winch, SIGWINCH);
+    winch_fd = signalfd(-1, &winch, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (winch_fd < 0) throw std::runtime_error("Failed to create signalfd");
+
+    view = &snapshots.read();
+    if (!replay) startCollector(); // a replay publishes from this thread (replayTick)
+
+    // Block in poll() on keyboard, resize and "snapshot published" events,
+    // plus any PSI triggers; keys are handled as they arrive regardless of
+    // the refresh interval
+    std::vector<struct pollfd> fds = {
+        {STDIN_FILENO, POLLIN, 0},
+        {winch_fd, POLLIN, 0},
+        {ui_wake_fd, POLLIN, 0},
+    };
+    const size_t kFirstTrigger = fds.size();
+    for (int fd : psi_trigger_fds) fds.push_back({fd, POLLPRI, 0});
+    bool dirty = true;
     while (running) {
-        resizeWindows();
-        collectData();
-
-        displaySystemInfo();
-        displayCPUInfo();
-        displayMemoryInfo();
-        displayDiskInfo();
-        displayDiskIOInfo();
-        displayProcessInfo();
-        displayAlert();
-
-        int ch = getch();
-        if (ch != ERR) handleInput(ch);
+        if (dirty) {
+            dirty = false;
+            renderFrame();
+        }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(config.refresh_rate_ms));
+        // wake up to take down an expired PSI alert
+        int timeout = -1;
+        if (!psi_alert.empty()) {
+            uint64_t now = monotonicNs();
+            timeout = (psi_alert_until_ns > now) ? (int)((psi_alert_until_ns - now) / 1000000ULL) + 1 : 0;
+        }
+        if (replay) {
+            int due = replayTimeoutMs();
+            if (due >= 0 && (timeout < 0 || due < timeout)) timeout = due;
+        }
+        if (::poll(fds.data(), fds.size(), timeout) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (size_t i = kFirstTrigger; i < fds.size(); ++i) {
+            if (fds[i].revents & POLLERR) {
+                debugLog("PSI trigger fd error, no longer polled");
+                fds[i].fd = -1;
+            } else if (fds[i].revents & POLLPRI) {
+                onPsiTrigger(i - kFirstTrigger);
+                dirty = true;
+            }
+        }
+        if (!psi_alert.empty() && monotonicNs() >= psi_alert_until_ns) {
+            psi_alert.clear();
+            invalidatePanels(); // the alert left its text on the top border
+            dirty = true;
+        }
+        if (fds[1].revents & POLLIN) {
+            struct signalfd_siginfo si;
+            while (::read(winch_fd, &si, sizeof(si)) == sizeof(si)) {}
+            resizeWindows();
+            dirty = true;
+        }
+        if (fds[2].revents & POLLIN) {
+            uint64_t n;
+            ssize_t r = ::read(ui_wake_fd, &n, sizeof(n));
+            (void)r;
+            dirty = true;
+        }
+        if (replay && replayTick()) dirty = true;
+        if (fds[0].revents & (POLLIN | POLLHUP)) {
+            int ch;
+            while (running && (ch = getch()) != ERR) {
+                handleInput(ch);
+                dirty = true;
+            }
+            if (fds[0].revents & POLLHUP) running = false; // terminal went away
+        }
     }
+    stopCollector();
+    ::close(winch_fd);
+    winch_fd = -1;
+    for (int fd : psi_trigger_fds) ::close(fd);
+    psi_trigger_fds.clear();
+    if (config.debug_mode && frame_count > 0)
+        debugLog("Frames: " + std::to_string(frame_count) + ", " +
+                 std::to_string(frame_bytes_total / frame_count) + " bytes and " +
+                 std::to_string((double)frame_writes_total / frame_count) + " writes per frame");
 
     if (sysinfo_win) delwin(toWin(sysinfo_win));
     if (cpu_win) delwin(toWin(cpu_win));
     if (mem_win) delwin(toWin(mem_win));
     if (disk_win) delwin(toWin(disk_win));
     if (diskio_win) delwin(toWin(diskio_win));
+    if (net_win) delwin(toWin(net_win));
     if (process_win) delwin(toWin(process_win));
+    if (overlay_win) delwin(toWin(overlay_win));
+    overlay_win = nullptr;
+    for (auto& ps : panel_surfaces) ps.reset();
     endwin();
+
+    if (config.overhead_summary) {
+        std::vector<std::string> report;
+        overheadReport(snapshots.read().overhead, report);
+        for (const std::string& line : report) printf("%s\n", line.c_str());
+    }
 }
@@ -0,0 +1,466 @@
+#include "../include/monitor.h"
+#include "../include/http_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <poll.h>
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+// ========================= PROMETHEUS =========================
+// One sample line: name, optional labels, value
+class Metric {
+public:
+    Metric(OutBuf& o, const char* name) : o(o) { o.put("activity_monitor_").put(name); }
+    Metric& label(const char* key, const char* value, size_t len) {
+        o.put(labels++ ? ',' : '{').put(key).put("=\"");
+        // label values escape backslash, quote and newline
+        for (size_t i = 0; i < len; ++i) {
+            char c = value[i];
+            if (c == '\\' || c == '"') o.put('\\').put(c);
+            else if (c == '\n') o.put("\\n");
+            else o.put(c);
+        }
+        o.put('"');
+        return *this;
+    }
+    Metric& label(const char* key, const std::string& value) { return label(key, value.data(), value.size()); }
+    Metric& label(const char* key, const char* value) { return label(key, value, strlen(value)); }
+    Metric& label(const char* key, long long value) {
+        char digits[24];
+        int n = 0;
+        unsigned long long v = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        do { digits[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+        if (value < 0) digits[n++] = '-';
+        std::reverse(digits, digits + n);
+        return label(key, digits, (size_t)n);
+    }
+    void value(double v) { end().putFixed(v).put('\n'); }
+
+private:
+    OutBuf& end() {
+        if (labels) o.put('}');
+        return o.put(' ');
+    }
+    OutBuf& o;
+    int labels = 0;
+};
+
+static void family(OutBuf& o, const char* name, const char* type, const char* help) {
+    o.put("# HELP activity_monitor_").put(name).put(' ').put(help).put('\n');
+    o.put("# TYPE activity_monitor_").put(name).put(' ').put(type).put('\n');
+}
+
+// A family with a single unlabeled gauge
+static void gauge(OutBuf& o, const char* name, const char* help, double v) {
+    family(o, name, "gauge", help);
+    Metric(o, name).value(v);
+}
+
+void writePrometheus(const MonitorSnapshot& s, int top_processes, OutBuf& o) {
+    const double kb = 1024.0, mb = 1024.0 * 1024.0;
+
+    gauge(o, "cpu_usage_percent", "Busy time of all CPUs.", s.cpu.total_usage);
+    family(o, "cpu_core_usage_percent", "gauge", "Busy time per logical CPU.");
+    for (size_t c = 0; c < s.cpu.core_usage.size(); ++c)
+        Metric(o, "cpu_core_usage_percent").label("cpu", (long long)c).value(s.cpu.core_usage[c]);
+
+    const MemoryInfo& m = s.memory;
+    gauge(o, "memory_total_bytes", "MemTotal.", m.total * kb);
+    gauge(o, "memory_free_bytes", "MemFree.", m.free * kb);
+    gauge(o, "memory_available_bytes", "MemAvailable.", m.available * kb);
+    gauge(o, "memory_used_bytes", "MemTotal minus MemAvailable.", m.used * kb);
+    gauge(o, "memory_cached_bytes", "Page cache.", m.cached * kb);
+    gauge(o, "memory_buffers_bytes", "Block device buffers.", m.buffers * kb);
+    gauge(o, "memory_swap_total_bytes", "SwapTotal.", m.swap_total * kb);
+    gauge(o, "memory_swap_used_bytes", "SwapTotal minus SwapFree.", m.swap_used * kb);
+    gauge(o, "memory_major_faults_per_second", "Major page faults.", m.major_faults_per_sec);
+    gauge(o, "memory_minor_faults_per_second", "Minor page faults.", m.minor_faults_per_sec);
+    gauge(o, "memory_pgscan_per_second", "Pages scanned for reclaim.", m.pgscan_per_sec);
+    gauge(o, "memory_pgsteal_per_second", "Pages reclaimed.", m.pgsteal_per_sec);
+    gauge(o, "memory_swap_in_pages_per_second", "Pages swapped in.", m.swap_in_per_sec);
+    gauge(o, "memory_swap_out_pages_per_second", "Pages swapped out.", m.swap_out_per_sec);
+    gauge(o, "memory_refaults_per_second", "Evicted pages faulted back in.", m.refaults_per_sec);
+
+    const SystemInfo& sys = s.system;
+    gauge(o, "uptime_seconds", "Time since boot.", sys.uptime_seconds);
+    family(o, "load_average", "gauge", "Load average.");
+    Metric(o, "load_average").label("window", "1m").value(sys.load_1min);
+    Metric(o, "load_average").label("window", "5m").value(sys.load_5min);
+    Metric(o, "load_average").label("window", "15m").value(sys.load_15min);
+    gauge(o, "context_switches_per_second", "Context switches.", sys.ctx_switches_per_sec);
+    gauge(o, "interrupts_per_second", "Interrupts.", sys.interrupts_per_sec);
+    gauge(o, "forks_per_second", "Processes created.", sys.forks_per_sec);
+    gauge(o, "procs_running", "Runnable tasks.", (double)sys.procs_running);
+    gauge(o, "procs_blocked", "Tasks blocked on I/O.", (double)sys.procs_blocked);
+
+    if (s.pressure.available) {
+        family(o, "pressure_avg10_percent", "gauge", "Share of the last 10s tasks were stalled on the resource.");
+        for (int r = 0; r < PsiResourceCount; ++r) {
+            const PsiResource& p = s.pressure.resource[r];
+            Metric(o, "pressure_avg10_percent").label("resource", psiResourceName(r)).label("kind", "some").value(p.some.avg10);
+            if (p.has_full)
+                Metric(o, "pressure_avg10_percent").label("resource", psiResourceName(r)).label("kind", "full").value(p.full.avg10);
+        }
+        family(o, "pressure_stall_seconds_total", "counter", "Total time tasks were stalled on the resource.");
+        for (int r = 0; r < PsiResourceCount; ++r) {
+            const PsiResource& p = s.pressure.resource[r];
+            Metric(o, "pressure_stall_seconds_total").label("resource", psiResourceName(r)).label("kind", "some").value(p.some.total_us / 1e6);
+            if (p.has_full)
+                Metric(o, "pressure_stall_seconds_total").label("resource", psiResourceName(r)).label("kind", "full").value(p.full.total_us / 1e6);
+        }
+    }
+
+    const DiskIOInfo& io = s.diskio;
+    gauge(o, "disk_read_bytes_per_second", "Bytes read, all disks counted in totals.", io.read_mb_per_sec * mb);
+    gauge(o, "disk_write_bytes_per_second", "Bytes written, all disks counted in totals.", io.write_mb_per_sec * mb);
+    gauge(o, "disk_busy_percent", "Utilisation of the busiest disk.", io.io_busy_percent);
+    const struct {
+        const char* name;
+        const char* help;
+        float DiskDeviceIO::*field;
+        double scale;
+    } kDisk[] = {
+        {"disk_device_read_bytes_per_second", "Bytes read.", &DiskDeviceIO::read_mb_per_sec, mb},
+        {"disk_device_write_bytes_per_second", "Bytes written.", &DiskDeviceIO::write_mb_per_sec, mb},
+        {"disk_device_reads_per_second", "Reads completed.", &DiskDeviceIO::read_ops_per_sec, 1.0},
+        {"disk_device_writes_per_second", "Writes completed.", &DiskDeviceIO::write_ops_per_sec, 1.0},
+        {"disk_device_queue_depth", "Average I/Os in flight.", &DiskDeviceIO::queue_depth, 1.0},
+        {"disk_device_util_percent", "Time with at least one I/O in flight.", &DiskDeviceIO::util_percent, 1.0},
+    };
+    for (const auto& f : kDisk) {
+        family(o, f.name, "gauge", f.help);
+        for (const DiskDeviceIO& d : io.devices)
+            Metric(o, f.name).label("device", d.name).value(d.*f.field * f.scale);
+    }
+    family(o, "disk_device_await_seconds", "gauge", "Time per completed I/O, queueing included.");
+    for (const DiskDeviceIO& d : io.devices)
+        if (d.await_ms >= 0) Metric(o, "disk_device_await_seconds").label("device", d.name).value(d.await_ms / 1000.0);
+
+    const struct {
+        const char* name;
+        const char* help;
+        float NetInterfaceIO::*field;
+        double scale;
+    } kNet[] = {
+        {"network_receive_bytes_per_second", "Bytes received.", &NetInterfaceIO::rx_mb_per_sec, mb},
+        {"network_transmit_bytes_per_second", "Bytes sent.", &NetInterfaceIO::tx_mb_per_sec, mb},
+        {"network_receive_packets_per_second", "Packets received.", &NetInterfaceIO::rx_packets_per_sec, 1.0},
+        {"network_transmit_packets_per_second", "Packets sent.", &NetInterfaceIO::tx_packets_per_sec, 1.0},
+        {"network_drops_per_second", "Packets dropped, both directions.", &NetInterfaceIO::drops_per_sec, 1.0},
+        {"network_errors_per_second", "Receive and transmit errors.", &NetInterfaceIO::errors_per_sec, 1.0},
+    };
+    for (const auto& f : kNet) {
+        family(o, f.name, "gauge", f.help);
+        for (const NetInterfaceIO& n : s.net.interfaces)
+            Metric(o, f.name).label("interface", n.name).value(n.*f.field * f.scale);
+    }
+    family(o, "network_util_percent", "gauge", "Busier direction against the link speed.");
+    for (const NetInterfaceIO& n : s.net.interfaces)
+        if (n.util_percent >= 0) Metric(o, "network_util_percent").label("interface", n.name).value(n.util_percent);
+
+    // top processes, in the order of the snapshot (CPU)
+    size_t top = std::min(s.processes.size(), (size_t)std::max(0, top_processes));
+    family(o, "process_cpu_percent", "gauge", "CPU of the busiest processes.");
+    for (size_t i = 0; i < top; ++i)
+        Metric(o, "process_cpu_percent").label("pid", (long long)s.processes[i].pid).label("name", s.processes[i].name)
+            .value(s.processes[i].cpu_percent);
+    family(o, "process_memory_percent", "gauge", "Resident memory of the busiest processes.");
+    for (size_t i = 0; i < top; ++i)
+        Metric(o, "process_memory_percent").label("pid", (long long)s.processes[i].pid).label("name", s.processes[i].name)
+            .value(s.processes[i].mem_percent);
+
+    // the monitor's own cost
+    family(o, "collector_tick_seconds", "gauge", "Median time of one collector tick.");
+    Metric(o, "collector_tick_seconds").value(s.overhead.tick_ns.p50 / 1e9);
+}
+
+// ========================= JSON LINES =========================
+// Length of the well-formed UTF-8 sequence at p (no overlongs, surrogates
+// or code points past U+10FFFF), or 0 if the bytes there are not one
+static size_t utf8Length(const unsigned char* p, size_t n) {
+    size_t len;
+    unsigned char lo = 0x80, hi = 0xbf; // allowed range of the second byte
+    if (p[0] >= 0xc2 && p[0] <= 0xdf) len = 2;
+    else if (p[0] >= 0xe0 && p[0] <= 0xef) {
+        len = 3;
+        if (p[0] == 0xe0) lo = 0xa0;
+        if (p[0] == 0xed) hi = 0x9f;
+    } else if (p[0] >= 0xf0 && p[0] <= 0xf4) {
+        len = 4;
+        if (p[0] == 0xf0) lo = 0x90;
+        if (p[0] == 0xf4) hi = 0x8f;
+    } else {
+        return 0;
+    }
+    if (n < len || p[1] < lo || p[1] > hi) return 0;
+    for (size_t i = 2; i < len; ++i)
+        if ((p[i] & 0xc0) != 0x80) return 0;
+    return len;
+}
+
+// Compact JSON into an OutBuf. Keys are literals and never escaped; commas
+// are tracked per nesting level.
+class JsonOut {
+public:
+    explicit JsonOut(OutBuf& o) : o(o) {}
+    JsonOut& open(const char* key, char bracket) {
+        sep(key);
+        o.put(bracket);
+        comma[++depth] = false;
+        return *this;
+    }
+    JsonOut& close(char bracket) {
+        o.put(bracket);
+        --depth;
+        return *this;
+    }
+    // Non-finite values (and negative "unknown" markers the caller maps
+    // to NaN) become null
+    JsonOut& num(const char* key, double v, int decimals = 2) {
+        sep(key);
+        if (std::isfinite(v)) o.putFixed(v, decimals);
+        else o.put("null");
+        return *this;
+    }
+    JsonOut& uint(const char* key, unsigned long long v) {
+        sep(key);
+        o.putUnsigned(v);
+        return *this;
+    }
+    JsonOut& boolean(const char* key, bool v) {
+        sep(key);
+        o.put(v ? "true" : "false");
+        return *this;
+    }
+    JsonOut& str(const char* key, const std::string& s) {
+        static const char kHex[] = "0123456789abcdef";
+        sep(key);
+        o.put('"');
+        const unsigned char* p = (const unsigned char*)s.data();
+        for (size_t i = 0, n = s.size(); i < n;) {
+            unsigned char c = p[i];
+            if (c == '"' || c == '\\') {
+                o.put('\\').put((char)c);
+                ++i;
+            } else if (c < 0x20) {
+                o.put("\\u00").put(kHex[c >> 4]).put(kHex[c & 15]);
+                ++i;
+            } else if (c < 0x80) {
+                o.put((char)c);
+                ++i;
+            } else if (size_t len = utf8Length(p + i, n - i)) {
+                o.put((const char*)p + i, len);
+                i += len;
+            } else {
+                // names are arbitrary bytes; one that is not UTF-8 is lost
+                o.put("\\ufffd");
+                ++i;
+            }
+        }
+        o.put('"');
+        return *this;
+    }
+
+private:
+    void sep(const char* key) {
+        if (comma[depth]) o.put(',');
+        comma[depth] = true;
+        if (key) o.put('"').put(key).put("\":");
+    }
+    OutBuf& o;
+    int depth = 0;
+    bool comma[16] = {};
+};
+
+void writeJson(const MonitorSnapshot& s, int top_processes, OutBuf& out) {
+    const double kUnknown = std::nan("");
+    JsonOut j(out);
+    j.open(nullptr, '{').uint("ts", s.wall_ms).uint("seq", s.seq);
+
+    j.open("cpu", '{').num("total", s.cpu.total_usage).open("cores", '[');
+    for (float c : s.cpu.core_usage) j.num(nullptr, c);
+    j.close(']').close('}');
+
+    const MemoryInfo& m = s.memory;
+    j.open("mem", '{')
+     .uint("total_kb", m.total).uint("used_kb", m.used).uint("available_kb", m.available)
+     .uint("cached_kb", m.cached).uint("buffers_kb", m.buffers).num("used_pct", m.percent_used)
+     .uint("swap_total_kb", m.swap_total).uint("swap_used_kb", m.swap_used).num("swap_pct", m.swap_percent_used)
+     .close('}');
+    j.open("vm", '{')
+     .num("majflt_per_s", m.major_faults_per_sec).num("minflt_per_s", m.minor_faults_per_sec)
+     .num("pgscan_per_s", m.pgscan_per_sec).num("pgsteal_per_s", m.pgsteal_per_sec)
+     .num("pswpin_per_s", m.swap_in_per_sec).num("pswpout_per_s", m.swap_out_per_sec)
+     .num("refault_per_s", m.refaults_per_sec)
+     .num("cache_pct", m.cache_effectiveness < 0 ? kUnknown : m.cache_effectiveness)
+     .close('}');
+
+    const SystemInfo& sys = s.system;
+    j.open("sys", '{').num("uptime_s", sys.uptime_seconds, 0)
+     .open("load", '[').num(nullptr, sys.load_1min).num(nullptr, sys.load_5min).num(nullptr, sys.load_15min).close(']')
+     .num("ctxt_per_s", sys.ctx_switches_per_sec, 0).num("intr_per_s", sys.interrupts_per_sec, 0)
+     .num("forks_per_s", sys.forks_per_sec, 0)
+     .uint("running", sys.procs_running).uint("blocked", sys.procs_blocked)
+     .close('}');
+
+    if (s.pressure.available) {
+        j.open("psi", '{');
+        for (int r = 0; r < PsiResourceCount; ++r) {
+            const PsiResource& p = s.pressure.resource[r];
+            j.open(psiResourceName(r), '{').num("some10", p.some.avg10).num("some60", p.some.avg60);
+            if (p.has_full) j.num("full10", p.full.avg10).num("full60", p.full.avg60);
+            j.close('}');
+        }
+        j.close('}');
+    }
+
+    const DiskIOInfo& io = s.diskio;
+    j.open("disk_io", '{')
+     .num("read_mb_s", io.read_mb_per_sec, 3).num("write_mb_s", io.write_mb_per_sec, 3)
+     .num("read_per_s", io.read_ops_per_sec, 1).num("write_per_s", io.write_ops_per_sec, 1)
+     .num("busy_pct", io.io_busy_percent, 1)
+     .open("devices", '[');
+    for (const DiskDeviceIO& d : io.devices) {
+        j.open(nullptr, '{').str("name", d.name).str("mount", d.mount_point).boolean("in_totals", d.in_totals)
+         .num("read_mb_s", d.read_mb_per_sec, 3).num("write_mb_s", d.write_mb_per_sec, 3)
+         .num("read_per_s", d.read_ops_per_sec, 1).num("write_per_s", d.write_ops_per_sec, 1)
+         .num("await_ms", d.await_ms < 0 ? kUnknown : d.await_ms).num("queue_depth", d.queue_depth)
+         .num("util_pct", d.util_percent, 1)
+         .close('}');
+    }
+    j.close(']').close('}');
+
+    const NetInfo& net = s.net;
+    j.open("net", '{')
+     .num("rx_mb_s", net.rx_mb_per_sec, 3).num("tx_mb_s", net.tx_mb_per_sec, 3)
+     .num("rx_pkt_per_s", net.rx_packets_per_sec, 0).num("tx_pkt_per_s", net.tx_packets_per_sec, 0)
+     .num("drops_per_s", net.drops_per_sec, 1).num("errors_per_s", net.errors_per_sec, 1)
+     .open("interfaces", '[');
+    for (const NetInterfaceIO& n : net.interfaces) {
+        j.open(nullptr, '{').str("name", n.name).boolean("in_totals", n.in_totals)
+         .num("rx_mb_s", n.rx_mb_per_sec, 3).num("tx_mb_s", n.tx_mb_per_sec, 3)
+         .num("rx_pkt_per_s", n.rx_packets_per_sec, 0).num("tx_pkt_per_s", n.tx_packets_per_sec, 0)
+         .num("drops_per_s", n.drops_per_sec, 1).num("errors_per_s", n.errors_per_sec, 1)
+         .num("util_pct", n.util_percent < 0 ? kUnknown : n.util_percent, 1)
+         .close('}');
+    }
+    j.close(']').close('}');
+
+    j.open("disks", '[');
+    for (const DiskInfo& d : s.disks) {
+        j.open(nullptr, '{').str("mount", d.mount_point).str("device", d.device)
+         .uint("total_kb", d.total_space).uint("free_kb", d.free_space).num("used_pct", d.percent_used, 1)
+         .boolean("stalled", d.stalled)
+         .close('}');
+    }
+    j.close(']');
+
+    j.open("temps", '[');
+    for (const auto& t : s.temperatures) j.open(nullptr, '{').str("label", t.first).num("c", t.second, 1).close('}');
+    j.close(']');
+
+    size_t top = std::min(s.processes.size(), (size_t)std::max(0, top_processes));
+    j.open("procs", '[');
+    for (size_t i = 0; i < top; ++i) {
+        const Process& p = s.processes[i];
+        j.open(nullptr, '{').uint("pid", (unsigned long long)p.pid).str("name", p.name)
+         .num("cpu", p.cpu_percent, 1).num("mem", p.mem_percent, 1)
+         .close('}');
+    }
+    j.close(']');
+
+    j.close('}');
+    out.put('\n');
+}
+
+// Headless batch mode, on this thread alone: the collector groups run on
+// their own periods as in collectorLoop, and a line goes to stdout each
+// time the CPU group ran (every --interval unless --period=cpu says
+// otherwise). Collectors that ran in between are in the next line, and in
+// the next --record frame. Each line is a single write().
+void ActivityMonitor::runJson() {
+    // stdout is usually a pipe, not a socket, so MSG_NOSIGNAL is no help:
+    // take a closed reader as EPIPE from write()
+    signal(SIGPIPE, SIG_IGN);
+    OutBuf line(16 * 1024);
+    resetSchedule(monotonicNs());
+    for (int lines = 0; config.json_count <= 0 || lines < config.json_count;) {
+        uint64_t deadline = schedule.top().deadline_ns;
+        struct timespec ts = {(time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+
+        uint32_t due = dueCollectors(monotonicNs());
+        collectData(due);
+        bool print = due & (1u << CollectCPU);
+        publishSnapshot(print); // record exactly the lines printed
+        if (!print) continue;
+
+        line.clear();
+        writeJson(snapshots.read(), config.top_processes, line);
+        for (size_t off = 0; off < line.size();) {
+            ssize_t n = ::write(STDOUT_FILENO, line.data() + off, line.size() - off);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return; // reader went away (EPIPE)
+            off += (size_t)n;
+        }
+        ++lines;
+    }
+}
+
+// Headless: collect on the collector thread and answer scrapes from the
+// latest snapshot. A scrape renders into a buffer kept between scrapes, and
+// only when a newer snapshot was published; it never reads /proc itself.
+void ActivityMonitor::runServe() {
+    HttpServer server;
+    std::string error;
+    if (!server.listen(config.serve_addr, error))
+        throw std::runtime_error("Cannot serve on " + config.serve_addr + ": " + error);
+
+    // stop cleanly on SIGINT/SIGTERM (blocked since setConfig) so a Unix
+    // socket is removed
+    sigset_t stop;
+    sigemptyset(&stop);
+    sigaddset(&stop, SIGINT);
+    sigaddset(&stop, SIGTERM);
+    int stop_fd = signalfd(-1, &stop, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (stop_fd < 0) throw std::runtime_error("Failed to create signalfd");
+
+    std::cerr << "Serving metrics on " << server.address() << " (GET /metrics)" << std::endl;
+    if (config.debug_mode) debugLog("Serving metrics on " + server.address());
+    startCollector();
+
+    OutBuf metrics(64 * 1024);
+    uint64_t rendered_seq = 0;
+    HttpServer::Route route = [&](const char* path, size_t len) -> const OutBuf* {
+        if (len != 8 || memcmp(path, "/metrics", 8) != 0) return nullptr;
+        const MonitorSnapshot& snap = snapshots.read();
+        if (snap.seq != rendered_seq) {
+            metrics.clear();
+            writePrometheus(snap, config.top_processes, metrics);
+            rendered_seq = snap.seq;
+        }
+        return &metrics;
+    };
+
+    std::vector<struct pollfd> fds;
+    for (;;) {
+        fds.clear();
+        fds.push_back({stop_fd, POLLIN, 0});
+        const size_t kFirstServer = fds.size();
+        server.pollFds(fds);
+        if (::poll(fds.data(), fds.size(), server.timeoutMs()) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & POLLIN) break;
+        server.handle(fds, kFirstServer, route);
+    }
+    stopCollector();
+    ::close(stop_fd);
+}
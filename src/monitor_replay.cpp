@@ -0,0 +1,177 @@
+#include "../include/monitor.h"
+#include "../include/recording.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+
+// ========================= REPLAY =========================
+// A recorded frame is decoded into the collector-owned state and goes
+// through the same history pushes and publishSnapshot() as a live tick,
+// so the panels draw a replay exactly as they drew the original run.
+
+void ActivityMonitor::openReplay() {
+    std::string error;
+    replay.reset(new RecordReader);
+    if (!replay->open(config.replay_path, error)) throw std::runtime_error("Cannot replay " + error);
+    if (!replayLoad(0)) throw std::runtime_error("Cannot replay " + config.replay_path + ": first frame is corrupt");
+    if (config.debug_mode)
+        debugLog("Replaying " + config.replay_path + ": " + std::to_string(replay->frames()) + " frames, " +
+                 std::to_string(replay->keyframes()) + " keyframes, " +
+                 std::to_string(replay->durationMs() / 1000) + "s");
+}
+
+bool ActivityMonitor::replayStep() {
+    uint32_t collectors;
+    uint64_t t_ms;
+    if (!replay->next(replay_frame, collectors, t_ms)) return false;
+    // swap rather than copy: the decoder overwrites all of replay_frame next time
+    std::swap(cpu_info, replay_frame.cpu);
+    std::swap(memory_info, replay_frame.memory);
+    std::swap(system_info, replay_frame.system);
+    pressure_info = replay_frame.pressure;
+    std::swap(diskio_info, replay_frame.diskio);
+    std::swap(net_info, replay_frame.net);
+    std::swap(disk_info, replay_frame.disks);
+    std::swap(processes, replay_frame.processes);
+    std::swap(temperatures, replay_frame.temperatures);
+    // pushHistory() grows a ring per core; never past the cores listed
+    cpu_info.num_cores = std::max(0, std::min(cpu_info.num_cores, (int)cpu_info.core_usage.size()));
+
+    // Net history slots go by interface name: an interface keeps its slot,
+    // a new one takes a slot never used before, then one whose interface
+    // is not in this frame
+    bool taken[kNetHistorySlots] = {};
+    for (NetInterfaceIO& io : net_info.interfaces) {
+        io.history_slot = -1;
+        for (int i = 0; i < kNetHistorySlots; ++i) {
+            if (!taken[i] && replay_net_names[i] == io.name) {
+                io.history_slot = i;
+                taken[i] = true;
+                break;
+            }
+        }
+    }
+    for (NetInterfaceIO& io : net_info.interfaces) {
+        if (io.history_slot < 0) {
+            int slot = -1;
+            for (int i = 0; i < kNetHistorySlots && slot < 0; ++i)
+                if (!taken[i] && replay_net_names[i].empty()) slot = i;
+            for (int i = 0; i < kNetHistorySlots && slot < 0; ++i)
+                if (!taken[i]) slot = i;
+            if (slot >= 0) {
+                taken[slot] = true;
+                replay_net_names[slot] = io.name;
+                net_rx_history[slot].clear();
+                net_tx_history[slot].clear();
+                io.history_slot = slot;
+            }
+        }
+        // frames without a net sample keep showing the rings as they are
+        io.rx_history = io.history_slot >= 0 ? net_rx_history[io.history_slot].span() : Span<float>();
+        io.tx_history = io.history_slot >= 0 ? net_tx_history[io.history_slot].span() : Span<float>();
+    }
+
+    for (int c = 0; c < CollectorCount; ++c)
+        if (collectors & (1u << c)) pushHistory(c, t_ms);
+    replay_t_ms = t_ms;
+    return true;
+}
+
+bool ActivityMonitor::replayNext() {
+    if (!replayStep()) return false;
+    sortProcesses();
+    publishSnapshot();
+    return true;
+}
+
+// Show keyframe k. Decoding starts far enough before it to fill the
+// graphs, so a jump does not leave them empty.
+bool ActivityMonitor::replayLoad(size_t k) {
+    size_t target = replay->keyframeFrame(k);
+    size_t from = k;
+    while (from > 0 && target - replay->keyframeFrame(from) < history_length) --from;
+    clearHistories();
+    for (std::string& name : replay_net_names) name.clear();
+    replay->seek(from);
+    bool any = false;
+    while (replay->position() <= target && replayStep()) any = true;
+    if (any) {
+        sortProcesses();
+        publishSnapshot();
+    }
+    replay_origin_ns = monotonicNs();
+    replay_origin_ms = replay_t_ms;
+    return any;
+}
+
+void ActivityMonitor::replaySeek(int direction) {
+    size_t shown = replay->position() ? replay->position() - 1 : 0;
+    size_t k = replay->keyframeBefore(shown);
+    if (direction < 0) {
+        // back to the start of this stretch, or of the one before if already there
+        if (shown == replay->keyframeFrame(k) && k > 0) --k;
+    } else {
+        if (k + 1 >= replay->keyframes()) return;
+        ++k;
+    }
+    replayLoad(k);
+}
+
+// When a frame recorded at t_ms is due on CLOCK_MONOTONIC
+static uint64_t replayDueNs(uint64_t origin_ns, uint64_t origin_ms, uint64_t t_ms, double speed) {
+    if (t_ms <= origin_ms) return origin_ns;
+    return origin_ns + (uint64_t)((double)(t_ms - origin_ms) * 1e6 / speed);
+}
+
+int ActivityMonitor::replayTimeoutMs() const {
+    uint64_t t;
+    if (replay_paused || !replay->peekTime(t)) return -1;
+    if (config.replay_speed <= 0) return 0;
+    uint64_t due = replayDueNs(replay_origin_ns, replay_origin_ms, t, config.replay_speed);
+    uint64_t now = monotonicNs();
+    return due <= now ? 0 : (int)std::min<uint64_t>((due - now + 999999) / 1000000, 60000);
+}
+
+bool ActivityMonitor::replayTick() {
+    if (replay_paused) return false;
+    bool any = false;
+    uint64_t t;
+    while (replay->peekTime(t)) {
+        if (config.replay_speed > 0 &&
+            replayDueNs(replay_origin_ns, replay_origin_ms, t, config.replay_speed) > monotonicNs())
+            break;
+        if (!replayStep()) {
+            replay_paused = true; // corrupt frame: stop here rather than spin on it
+            debugLog("Replay stopped at a corrupt frame");
+            break;
+        }
+        any = true;
+        if (config.replay_speed <= 0) break; // max speed: one frame per drawn frame
+    }
+    if (any) {
+        sortProcesses();
+        publishSnapshot();
+    }
+    return any;
+}
+
+// " REPLAY 10-16 12:34:56 4x 37% PAUSED": wall clock of the frame shown,
+// speed, position in the recording and state
+std::string ActivityMonitor::replayStatus() const {
+    char when[32] = "";
+    time_t secs = (time_t)(replay_frame.wall_ms / 1000);
+    struct tm tm;
+    if (localtime_r(&secs, &tm)) strftime(when, sizeof(when), "%m-%d %H:%M:%S", &tm);
+    char speed[16];
+    if (config.replay_speed <= 0) snprintf(speed, sizeof(speed), "max");
+    else snprintf(speed, sizeof(speed), "%gx", config.replay_speed);
+    size_t frames = replay->frames();
+    size_t shown = replay->position() ? replay->position() - 1 : 0;
+    unsigned pct = frames > 1 ? (unsigned)(100 * shown / (frames - 1)) : 100;
+    uint64_t t;
+    const char* state = replay_paused ? "PAUSED" : !replay->peekTime(t) ? "END" : "";
+    char buf[96];
+    snprintf(buf, sizeof(buf), " REPLAY %s %s %u%% %s", when, speed, pct, state);
+    return buf;
+}
@@ -0,0 +1,138 @@
+#include "../include/mount_table.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// Filesystems with no disk space worth showing
+static const char* const kPseudoFs[] = {
+    "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs",
+    "devpts", "devtmpfs", "efivarfs", "fusectl", "hugetlbfs", "mqueue", "nsfs",
+    "overlay", "proc", "pstore", "ramfs", "rootfs", "rpc_pipefs", "securityfs",
+    "selinuxfs", "squashfs", "sysfs", "tmpfs", "tracefs",
+};
+
+bool MountTable::isPseudoFs(const std::string& fs_type) {
+    for (const char* t : kPseudoFs)
+        if (fs_type == t) return true;
+    return false;
+}
+
+MountTable::MountTable() {
+    mountinfo_fd = ::open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+}
+
+MountTable::~MountTable() {
+    if (mountinfo_fd >= 0) ::close(mountinfo_fd);
+}
+
+bool MountTable::refresh() {
+    if (mountinfo_fd >= 0 && !changed) {
+        // nobody else polls the fd (e.g. debug mode): look for the event here
+        struct pollfd p = {mountinfo_fd, POLLPRI, 0};
+        if (::poll(&p, 1, 0) > 0 && (p.revents & (POLLPRI | POLLERR))) changed = true;
+    }
+    if (!changed) return false;
+    if (!load()) return false; // keep the old table
+    changed = (mountinfo_fd < 0);
+    return true;
+}
+
+// Mount fields escape space, tab, newline and backslash as \ooo
+static std::string unescape(const char* p, const char* end) {
+    std::string s;
+    s.reserve((size_t)(end - p));
+    while (p < end) {
+        if (*p == '\\' && end - p >= 4 &&
+            (unsigned)(p[1] - '0') < 8u && (unsigned)(p[2] - '0') < 8u && (unsigned)(p[3] - '0') < 8u) {
+            s += (char)((p[1] - '0') * 64 + (p[2] - '0') * 8 + (p[3] - '0'));
+            p += 4;
+        } else {
+            s += *p++;
+        }
+    }
+    return s;
+}
+
+// 36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+// (1)(2)(3)   (4)   (5)      (6)       (7...)  - (8)    (9)        (10)
+bool MountTable::load() {
+    int fd = mountinfo_fd;
+    if (fd < 0) {
+        fd = ::open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+    } else if (::lseek(fd, 0, SEEK_SET) < 0) {
+        return false;
+    }
+    if (buf.empty()) buf.resize(64 * 1024);
+    size_t len = 0;
+    for (;;) {
+        if (len == buf.size()) buf.resize(buf.size() * 2);
+        ssize_t n = ::read(fd, buf.data() + len, buf.size() - len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (n == 0) break;
+        len += (size_t)n;
+    }
+    if (fd != mountinfo_fd) ::close(fd);
+
+    entries.clear();
+    std::unordered_map<unsigned long long, size_t> by_dev; // major:minor -> index
+    std::vector<bool> whole; // entry mounts the filesystem root, not a bind of a subtree
+    const char* p = buf.data();
+    const char* end = p + len;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+
+        const char* field[10];
+        const char* field_end[10];
+        int nf = 0;
+        bool after_sep = false;
+        for (const char* q = p; q < eol && nf < 10;) {
+            const char* e = static_cast<const char*>(memchr(q, ' ', (size_t)(eol - q)));
+            if (!e) e = eol;
+            // optional fields (7) run up to a lone "-"
+            if (nf == 6 && !after_sep) {
+                if (e - q == 1 && *q == '-') after_sep = true;
+            } else {
+                field[nf] = q;
+                field_end[nf] = e;
+                ++nf;
+            }
+            q = e + 1;
+        }
+        p = eol + 1;
+        if (nf < 8 || !after_sep) continue;
+
+        MountEntry m;
+        m.fs_type.assign(field[6], field_end[6]);
+        if (isPseudoFs(m.fs_type)) continue;
+        if (sscanf(field[2], "%u:%u", &m.major, &m.minor) != 2) continue;
+        m.mount_point = unescape(field[4], field_end[4]);
+        m.source = unescape(field[7], field_end[7]);
+        bool is_root = (field_end[3] - field[3] == 1 && *field[3] == '/');
+
+        unsigned long long dev = ((unsigned long long)m.major << 32) | m.minor;
+        auto it = by_dev.find(dev);
+        if (it == by_dev.end()) {
+            by_dev[dev] = entries.size();
+            entries.push_back(std::move(m));
+            whole.push_back(is_root);
+        } else if (is_root && !whole[it->second]) {
+            // prefer the mount of the whole filesystem over a bind mount
+            entries[it->second] = std::move(m);
+            whole[it->second] = true;
+        }
+    }
+
+    points.clear();
+    for (const MountEntry& m : entries) points.push_back(m.mount_point);
+    ++loads;
+    return true;
+}
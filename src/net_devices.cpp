@@ -0,0 +1,105 @@
+#include "../include/net_devices.h"
+#include "../include/procfs.h"
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <unistd.h>
+
+// Interface lines of /proc/net/dev look like "  eth0: 1234 56 0 0 ...";
+// the two header lines have no ':'. Advances p past the line.
+static bool nextInterface(const char*& p, const char* end, const char*& name, size_t& name_len, const char*& data,
+                          const char*& eol) {
+    while (p < end) {
+        const char* line = p;
+        eol = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+        p = eol + 1;
+        const char* colon = static_cast<const char*>(memchr(line, ':', (size_t)(eol - line)));
+        if (!colon) continue;
+        while (line < colon && *line == ' ') ++line;
+        name = line;
+        name_len = (size_t)(colon - line);
+        data = colon + 1;
+        return true;
+    }
+    return false;
+}
+
+//   rx: bytes packets errs drop fifo frame compressed multicast
+//   tx: bytes packets errs drop fifo colls carrier compressed
+static void parseCounters(const char* p, const char* eol, NetDevCounters& c) {
+    unsigned long long f[12] = {};
+    for (int i = 0; i < 12 && p < eol; ++i) {
+        while (p < eol && *p == ' ') ++p;
+        p = parseDecimal(p, eol, f[i]);
+    }
+    c.rx_bytes = f[0];
+    c.rx_packets = f[1];
+    c.rx_errors = f[2];
+    c.rx_dropped = f[3];
+    c.tx_bytes = f[8];
+    c.tx_packets = f[9];
+    c.tx_errors = f[10];
+    c.tx_dropped = f[11];
+}
+
+// Read a small integer sysfs attribute; false if it is missing or refused
+// (speed fails with EINVAL while the link is down)
+static bool readSysfsLong(const std::string& path, long& out) {
+    char buf[32];
+    if (readProcFile(path.c_str(), buf, sizeof(buf)) <= 0) return false;
+    char* end = nullptr;
+    out = strtol(buf, &end, 10);
+    return end != buf;
+}
+
+bool NetInterfaceTable::parse(const char* buf, size_t len, std::vector<NetDevCounters>& counters) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const char* p = buf;
+        const char* end = buf + len;
+        const char *name, *data, *eol;
+        size_t name_len, i = 0;
+        bool same = true;
+        counters.resize(ifaces.size());
+        while (nextInterface(p, end, name, name_len, data, eol)) {
+            if (i >= ifaces.size() || ifaces[i].name.size() != name_len ||
+                memcmp(ifaces[i].name.data(), name, name_len) != 0) {
+                same = false;
+                break;
+            }
+            parseCounters(data, eol, counters[i++]);
+        }
+        if (same && i == ifaces.size()) return i > 0;
+        rebuild(buf, len); // an interface came, went or was renamed
+    }
+    return false;
+}
+
+void NetInterfaceTable::rebuild(const char* buf, size_t len) {
+    std::unordered_map<std::string, NetInterface> old;
+    for (NetInterface& n : ifaces) old[n.name] = std::move(n);
+    ifaces.clear();
+
+    const char* p = buf;
+    const char* end = buf + len;
+    const char *name, *data, *eol;
+    size_t name_len;
+    while (nextInterface(p, end, name, name_len, data, eol)) {
+        NetInterface n;
+        n.name.assign(name, name_len);
+        auto it = old.find(n.name);
+        if (it != old.end()) {
+            n.last = it->second.last;
+            n.sampled = it->second.sampled;
+            n.history_slot = it->second.history_slot;
+            old.erase(it);
+        }
+        std::string base = "/sys/class/net/" + n.name + "/";
+        long type = 0, speed = 0;
+        n.loopback = readSysfsLong(base + "type", type) && type == 772; // ARPHRD_LOOPBACK
+        n.physical = access((base + "device").c_str(), F_OK) == 0;
+        if (readSysfsLong(base + "speed", speed) && speed > 0) n.speed_mbps = speed;
+        ifaces.push_back(std::move(n));
+    }
+    ++rebuilds;
+}
@@ -0,0 +1,52 @@
+#include "../include/out_buf.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+OutBuf& OutBuf::putUnsigned(unsigned long long v) {
+    char digits[20];
+    int n = 0;
+    do { digits[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+    if (len + n > buf.size()) grow((size_t)n);
+    while (n) buf[len++] = digits[--n];
+    return *this;
+}
+
+OutBuf& OutBuf::putInt(long long v) {
+    if (v < 0) {
+        put('-');
+        return putUnsigned(0ULL - (unsigned long long)v);
+    }
+    return putUnsigned((unsigned long long)v);
+}
+
+OutBuf& OutBuf::putFixed(double v, int decimals) {
+    if (std::isnan(v)) return put("NaN");
+    if (std::isinf(v)) return put(v > 0 ? "+Inf" : "-Inf");
+    decimals = std::max(0, std::min(9, decimals));
+    static const unsigned long long kPow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000,
+                                                10000000, 100000000, 1000000000};
+    unsigned long long scale = kPow10[decimals];
+    double mag = std::fabs(v);
+    if (mag * scale >= 1e18) {
+        // too large for fixed point; rare enough for snprintf
+        char tmp[32];
+        int n = snprintf(tmp, sizeof(tmp), "%.17g", v);
+        return put(tmp, (size_t)std::max(0, n));
+    }
+    unsigned long long scaled = (unsigned long long)(mag * scale + 0.5);
+    if (scaled == 0) return put('0');
+    if (v < 0) put('-');
+    putUnsigned(scaled / scale);
+    unsigned long long frac = scaled % scale;
+    if (frac == 0) return *this;
+    char digits[9];
+    int n = decimals;
+    for (int i = n - 1; i >= 0; --i) {
+        digits[i] = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    while (n > 0 && digits[n - 1] == '0') --n;
+    put('.');
+    return put(digits, (size_t)n);
+}
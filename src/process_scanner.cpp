@@ -0,0 +1,224 @@
+#include "../include/process_scanner.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+// Below this many PIDs per shard the thread handoff costs more than it saves
+static const size_t kMinPidsPerShard = 128;
+// Read size per stat file; a stat line is well under 1 KB
+static const size_t kStatBufSize = 1024;
+// Reads in flight per io_uring submission
+static const unsigned kUringBatch = 256;
+
+int ProcessScanner::defaultThreads() {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online <= 0) online = 1;
+    // one worker per 16 CPUs, capped: the scan is bound by procfs locking
+    // well before it runs out of cores
+    return (int)std::max(1L, std::min(8L, online / 16));
+}
+
+void ProcessScanner::setThreads(int threads) {
+    if (threads <= 0) threads = defaultThreads();
+    pool.resize((size_t)threads);
+}
+
+void ProcessScanner::setFdCache(bool enabled, size_t max_fds) {
+    use_fd_cache = enabled;
+    fd_cache.setLimit(max_fds);
+    if (!fdCacheEnabled()) fd_cache.clear();
+}
+
+void ProcessScanner::setBackend(ScanBackend requested) {
+    active = ScanBackend::Pread;
+    if (requested != ScanBackend::Pread && uring.init(kUringBatch)) {
+        active = ScanBackend::Uring;
+        uring_bufs.resize((size_t)uring.capacity() * kStatBufSize);
+    } else {
+        uring.shutdown();
+    }
+    if (!fdCacheEnabled()) fd_cache.clear();
+}
+
+const char* ProcessScanner::backendName(ScanBackend b) {
+    switch (b) {
+        case ScanBackend::Auto: return "auto";
+        case ScanBackend::Pread: return "pread";
+        case ScanBackend::Uring: return "io_uring";
+    }
+    return "?";
+}
+
+void ProcessScanner::listPids() {
+    if (!pid_enum.list(pids)) throw std::runtime_error("Failed to read /proc");
+}
+
+// Copy the interesting fields of a stat line into a record
+static bool fillRecord(ProcScanRecord& r, const char* buf, size_t n) {
+    ProcStatFields ps;
+    if (!parseProcStat(buf, n, ps)) return false;
+    size_t clen = std::min(ps.comm_len, sizeof(r.comm));
+    memcpy(r.comm, ps.comm, clen);
+    r.comm_len = (unsigned char)clen;
+    r.starttime = ps.starttime;
+    r.cpu_ticks = ps.utime + ps.stime;
+    r.rss_pages = ps.rss_pages;
+    r.ok = true;
+    return true;
+}
+
+void ProcessScanner::scanShard(size_t begin, size_t end, unsigned long& syscalls) {
+    char statbuf[kStatBufSize];
+    char path[64];
+    bool keep_fds = fdCacheEnabled();
+    for (size_t i = begin; i < end; ++i) {
+        ProcScanRecord& r = recs[i];
+        if (r.ok) continue; // already filled by the io_uring pass
+        ssize_t n = -1;
+        if (r.cached_fd >= 0 && !r.dead) {
+            n = preadProcFd(r.cached_fd, statbuf, sizeof(statbuf), &syscalls);
+            if (n > 0) r.hit = true;
+            else r.dead = true; // ESRCH; the PID may be reused, reopen below
+        }
+        if (n <= 0) {
+            if (r.new_fd >= 0) {
+                // opened for io_uring but the read failed; retry from scratch
+                ::close(r.new_fd);
+                ++syscalls;
+                r.new_fd = -1;
+            }
+            formatProcPath(path, r.pid, "stat");
+            int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            ++syscalls;
+            r.opened = true;
+            if (fd < 0) continue;
+            n = preadProcFd(fd, statbuf, sizeof(statbuf), &syscalls);
+            if (keep_fds && n > 0 && keep_budget.fetch_sub(1) > 0) {
+                r.new_fd = fd;
+            } else {
+                ::close(fd);
+                ++syscalls;
+            }
+            if (n <= 0) continue;
+        }
+        fillRecord(r, statbuf, (size_t)n);
+    }
+}
+
+void ProcessScanner::onUringRead(void* ctx, uint64_t index, int res) {
+    ProcessScanner* self = static_cast<ProcessScanner*>(ctx);
+    ProcScanRecord& r = self->recs[index];
+    if (res <= 0) {
+        // the task exited (ESRCH) or the read failed; a cached fd is
+        // dropped and the pread pass retries with a fresh open
+        if (r.cached_fd >= 0) r.dead = true;
+        return;
+    }
+    char* buf = &self->uring_bufs[(index - self->uring_batch_start) * kStatBufSize];
+    buf[res] = '\0';
+    if (fillRecord(r, buf, (size_t)res) && r.cached_fd >= 0) r.hit = true;
+}
+
+void ProcessScanner::scanUring(unsigned long& syscalls) {
+    char path[64];
+    size_t count = recs.size();
+
+    for (size_t start = 0; start < count; start += uring.capacity()) {
+        size_t end = std::min(count, start + uring.capacity());
+        uring_batch_start = start;
+        // io_uring reads need open fds: reuse cached ones and open the rest,
+        // as far as the fd budget goes. PIDs left without an fd are read by
+        // the pread pass.
+        for (size_t i = start; i < end; ++i) {
+            ProcScanRecord& r = recs[i];
+            if (r.cached_fd < 0 && keep_budget > 0) {
+                formatProcPath(path, r.pid, "stat");
+                r.new_fd = ::open(path, O_RDONLY | O_CLOEXEC);
+                ++syscalls;
+                r.opened = true;
+                if (r.new_fd >= 0) --keep_budget;
+            }
+            int fd = (r.cached_fd >= 0) ? r.cached_fd : r.new_fd;
+            if (fd < 0) continue;
+            uring.queueRead(fd, &uring_bufs[(i - start) * kStatBufSize], (unsigned)kStatBufSize - 1, i);
+        }
+        unsigned long enters_before = uring.enterCalls();
+        int reaped = uring.submitAndWait(&ProcessScanner::onUringRead, this);
+        unsigned long enters = uring.enterCalls() - enters_before;
+        syscalls += enters;
+        last_stats.uring_enters += enters;
+        // a fresh fd whose read failed is not kept; the pread pass reopens
+        for (size_t i = start; i < end; ++i) {
+            ProcScanRecord& r = recs[i];
+            if (r.new_fd < 0 || r.ok) continue;
+            ::close(r.new_fd);
+            ++syscalls;
+            r.new_fd = -1;
+            ++keep_budget;
+        }
+        if (reaped < 0) {
+            // ring broke (e.g. the process was restricted after startup):
+            // stay on pread from now on; the pread pass covers the rest
+            uring.shutdown();
+            active = ScanBackend::Pread;
+            break;
+        }
+    }
+}
+
+size_t ProcessScanner::scan() {
+    auto t0 = std::chrono::steady_clock::now();
+    last_stats = ScanStats();
+
+    listPids();
+    size_t count = pids.size();
+    unsigned long syscalls = pid_enum.lastCalls();
+    bool keep_fds = fdCacheEnabled();
+
+    // pre-size the output so every shard writes to its own slice
+    recs.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        ProcScanRecord& r = recs[i];
+        r.pid = pids[i];
+        r.ok = r.hit = r.dead = r.opened = false;
+        r.new_fd = -1;
+        r.cached_fd = keep_fds ? fd_cache.lookup(r.pid) : -1;
+    }
+    // every fd kept until commit() is open at once, so stay within the
+    // cache limit (RLIMIT_NOFILE minus headroom) during the scan too
+    keep_budget = keep_fds ? (long)fd_cache.limit() - (long)fd_cache.size() : 0;
+
+    if (active == ScanBackend::Uring) scanUring(syscalls);
+
+    // pread pass: the whole scan for the pread backend, and retries of
+    // exited/reused PIDs after an io_uring pass
+    size_t shards = std::min(pool.size(), std::max<size_t>(1, count / kMinPidsPerShard));
+    if (active == ScanBackend::Uring) shards = 1;
+    shard_syscalls.assign(shards, 0);
+    pool.run(shards, [&](size_t shard) {
+        size_t begin = count * shard / shards;
+        size_t end = count * (shard + 1) / shards;
+        scanShard(begin, end, shard_syscalls[shard]);
+    });
+    for (unsigned long c : shard_syscalls) syscalls += c;
+
+    if (keep_fds) {
+        for (size_t i = 0; i < count; ++i) {
+            const ProcScanRecord& r = recs[i];
+            fd_cache.commit(r.pid, r.hit, r.dead, r.opened, r.new_fd);
+        }
+        fd_cache.sweep();
+        syscalls += fd_cache.lastStats().evictions + fd_cache.lastStats().uncached;
+        // the io_uring backend was dropped mid-scan and nothing else wants fds
+        if (!fdCacheEnabled()) fd_cache.clear();
+    }
+
+    last_stats.pids = count;
+    last_stats.syscalls = syscalls;
+    last_stats.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return count;
+}
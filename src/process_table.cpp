@@ -0,0 +1,146 @@
+#include "../include/process_table.h"
+
+uint32_t NamePool::intern(std::string_view name) {
+    auto it = index.find(name);
+    if (it != index.end()) {
+        ++refs[it->second];
+        return it->second;
+    }
+    uint32_t idx;
+    if (!free_idx.empty()) {
+        idx = free_idx.back();
+        free_idx.pop_back();
+        names[idx].assign(name);
+        refs[idx] = 1;
+    } else {
+        idx = (uint32_t)names.size();
+        names.emplace_back(name);
+        refs.push_back(1);
+    }
+    index.emplace(std::string_view(names[idx]), idx);
+    return idx;
+}
+
+void NamePool::release(uint32_t idx) {
+    if (--refs[idx] > 0) return;
+    index.erase(std::string_view(names[idx]));
+    std::string().swap(names[idx]);
+    free_idx.push_back(idx);
+}
+
+ProcessTable::ProcessTable() {
+    bucket_pid.assign(1024, 0);
+    bucket_slot.assign(1024, kEmpty);
+    mask = 1024 - 1;
+}
+
+size_t ProcessTable::findBucket(int pid) const {
+    size_t b = home(pid);
+    while (bucket_slot[b] != kEmpty && bucket_pid[b] != pid) b = (b + 1) & mask;
+    return b;
+}
+
+void ProcessTable::insertIndex(int pid, int32_t slot) {
+    // keep the load factor at or below 1/2 so probe chains stay short
+    if ((pids.size() + 1) * 2 > bucket_slot.size()) growIndex();
+    size_t b = findBucket(pid);
+    bucket_pid[b] = pid;
+    bucket_slot[b] = slot;
+}
+
+void ProcessTable::eraseIndex(int pid) {
+    size_t i = findBucket(pid);
+    if (bucket_slot[i] == kEmpty) return;
+    bucket_slot[i] = kEmpty;
+    // backward-shift the rest of the cluster so lookups need no tombstones
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (bucket_slot[j] == kEmpty) break;
+        size_t k = home(bucket_pid[j]);
+        bool movable = (j > i) ? (k <= i || k > j) : (k <= i && k > j);
+        if (movable) {
+            bucket_pid[i] = bucket_pid[j];
+            bucket_slot[i] = bucket_slot[j];
+            bucket_slot[j] = kEmpty;
+            i = j;
+        }
+    }
+}
+
+void ProcessTable::growIndex() {
+    size_t cap = bucket_slot.size() * 2;
+    bucket_pid.assign(cap, 0);
+    bucket_slot.assign(cap, kEmpty);
+    mask = cap - 1;
+    for (size_t s = 0; s < pids.size(); ++s) {
+        size_t b = findBucket(pids[s]);
+        bucket_pid[b] = pids[s];
+        bucket_slot[b] = (int32_t)s;
+    }
+}
+
+size_t ProcessTable::update(int pid, unsigned long long starttime, unsigned long long ticks,
+                            unsigned long long rss, std::string_view name, unsigned long long& delta_ticks) {
+    size_t b = findBucket(pid);
+    if (bucket_slot[b] != kEmpty) {
+        size_t slot = (size_t)bucket_slot[b];
+        if (starttimes[slot] == starttime) {
+            delta_ticks = (ticks > cpu_ticks[slot]) ? (ticks - cpu_ticks[slot]) : 0;
+        } else {
+            // same PID, different process: start its history from scratch
+            delta_ticks = 0;
+            starttimes[slot] = starttime;
+        }
+        cpu_ticks[slot] = ticks;
+        rss_kb[slot] = rss;
+        // comm only changes on exec, so re-intern only when it differs
+        if (name_pool.get(name_idx[slot]) != name) {
+            uint32_t old = name_idx[slot];
+            name_idx[slot] = name_pool.intern(name);
+            name_pool.release(old);
+        }
+        seen_gen[slot] = generation;
+        return slot;
+    }
+
+    size_t slot = pids.size();
+    insertIndex(pid, (int32_t)slot);
+    pids.push_back(pid);
+    starttimes.push_back(starttime);
+    cpu_ticks.push_back(ticks);
+    rss_kb.push_back(rss);
+    name_idx.push_back(name_pool.intern(name));
+    cpu_percent.push_back(0.0f);
+    seen_gen.push_back(generation);
+    delta_ticks = 0;
+    return slot;
+}
+
+void ProcessTable::sweep() {
+    size_t s = 0;
+    while (s < pids.size()) {
+        if (seen_gen[s] == generation) { ++s; continue; }
+        eraseIndex(pids[s]);
+        name_pool.release(name_idx[s]);
+        size_t last = pids.size() - 1;
+        if (s != last) {
+            pids[s] = pids[last];
+            starttimes[s] = starttimes[last];
+            cpu_ticks[s] = cpu_ticks[last];
+            rss_kb[s] = rss_kb[last];
+            name_idx[s] = name_idx[last];
+            cpu_percent[s] = cpu_percent[last];
+            seen_gen[s] = seen_gen[last];
+            bucket_slot[findBucket(pids[s])] = (int32_t)s;
+        }
+        pids.pop_back();
+        starttimes.pop_back();
+        cpu_ticks.pop_back();
+        rss_kb.pop_back();
+        name_idx.pop_back();
+        cpu_percent.pop_back();
+        seen_gen.pop_back();
+        // re-check slot s, which now holds what was the last slot
+    }
+}
@@ -0,0 +1,356 @@
+#include "../include/procfs.h"
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <cstdint>
+
+ssize_t readProcFile(const char* path, char* buf, size_t cap, unsigned long* syscalls) {
+    if (cap == 0) return -1;
+    unsigned long calls = 1;
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (syscalls) *syscalls += calls;
+        return -1;
+    }
+    size_t total = 0;
+    while (total < cap - 1) {
+        ssize_t n = ::read(fd, buf + total, cap - 1 - total);
+        ++calls;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            int saved = errno;
+            ::close(fd);
+            if (syscalls) *syscalls += calls + 1;
+            errno = saved;
+            return -1;
+        }
+        if (n == 0) break;
+        // no shortcut on a short read: seq_file hands multi-record files
+        // (smaps, diskstats, net/dev) out a page or so at a time
+        total += (size_t)n;
+    }
+    ::close(fd);
+    if (syscalls) *syscalls += calls + 1;
+    buf[total] = '\0';
+    return (ssize_t)total;
+}
+
+ssize_t readProcFileGrow(const char* path, std::vector<char>& buf) {
+    if (buf.size() < 2) buf.resize(4096);
+    for (;;) {
+        ssize_t n = readProcFile(path, buf.data(), buf.size());
+        if (n < 0 || (size_t)n + 1 < buf.size()) return n;
+        buf.resize(buf.size() * 2); // possibly truncated
+    }
+}
+
+// Advance past the current field and the single space that follows it.
+static inline const char* skipField(const char* p, const char* end) {
+    while (p < end && *p != ' ') ++p;
+    return (p < end) ? p + 1 : end;
+}
+
+bool parseProcStat(const char* buf, size_t len, ProcStatFields& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+
+    unsigned long long pid = 0;
+    p = parseDecimal(p, end, pid);
+    if (p + 2 > end || p[0] != ' ' || p[1] != '(') return false;
+    const char* comm = p + 2;
+
+    // comm may itself contain ')', so the real terminator is the last one
+    const char* close = static_cast<const char*>(memrchr(comm, ')', (size_t)(end - comm)));
+    if (!close || close + 2 >= end) return false;
+
+    out.pid = (int)pid;
+    out.comm = comm;
+    out.comm_len = (size_t)(close - comm);
+
+    // field 3 (state) starts two bytes after ')'
+    p = close + 2;
+    out.state = *p;
+
+    // skip fields 3..9 to reach minflt (field 10), then 10..13 to utime (14)
+    for (int field = 3; field < 10; ++field) p = skipField(p, end);
+    if (p >= end) return false;
+    parseDecimal(p, end, out.minflt);
+    for (int field = 10; field < 14; ++field) p = skipField(p, end);
+    if (p >= end) return false;
+    p = parseDecimal(p, end, out.utime);
+    p = skipField(p, end);
+    if (p >= end) return false;
+    p = parseDecimal(p, end, out.stime);
+
+    // skip fields 15..21 to reach starttime (field 22)
+    for (int field = 15; field < 22; ++field) p = skipField(p, end);
+    if (p >= end) return false;
+    p = parseDecimal(p, end, out.starttime);
+
+    // skip fields 22..23 to reach rss (field 24)
+    for (int field = 22; field < 24; ++field) p = skipField(p, end);
+    if (p >= end) return false;
+    parseDecimal(p, end, out.rss_pages);
+    return true;
+}
+
+// Skip spaces (not newlines) before the next number
+static inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && *p == ' ') ++p;
+    return p;
+}
+
+static inline bool hasPrefix(const char* p, const char* end, const char* prefix, size_t n) {
+    return (size_t)(end - p) >= n && memcmp(p, prefix, n) == 0;
+}
+
+bool parseSystemStat(const char* buf, size_t len, SystemStatSnapshot& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+    out.cpu_total.clear();
+    out.cpu_idle.clear();
+
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+
+        if (hasPrefix(p, eol, "cpu", 3)) {
+            // label (cpu, cpu0, ...) then user nice system idle iowait irq softirq steal
+            const char* q = p + 3;
+            while (q < eol && *q != ' ') ++q;
+            unsigned long long v[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+            for (int i = 0; i < 8 && q < eol; ++i) q = parseDecimal(skipBlanks(q, eol), eol, v[i]);
+            out.cpu_total.push_back(v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7]);
+            out.cpu_idle.push_back(v[3] + v[4]);
+        } else if (hasPrefix(p, eol, "intr ", 5)) {
+            // only the total; the rest of the line is skipped via eol
+            parseDecimal(skipBlanks(p + 5, eol), eol, out.intr_total);
+        } else if (hasPrefix(p, eol, "ctxt ", 5)) {
+            parseDecimal(skipBlanks(p + 5, eol), eol, out.ctxt);
+        } else if (hasPrefix(p, eol, "processes ", 10)) {
+            parseDecimal(skipBlanks(p + 10, eol), eol, out.processes);
+        } else if (hasPrefix(p, eol, "procs_running ", 14)) {
+            parseDecimal(skipBlanks(p + 14, eol), eol, out.procs_running);
+        } else if (hasPrefix(p, eol, "procs_blocked ", 14)) {
+            parseDecimal(skipBlanks(p + 14, eol), eol, out.procs_blocked);
+        }
+        p = eol + 1;
+    }
+    return !out.cpu_total.empty();
+}
+
+bool parseVmStat(const char* buf, size_t len, VmStatCounters& out) {
+    static const struct {
+        const char* key;
+        unsigned long long VmStatCounters::*field;
+    } keys[] = {
+        {"pgfault", &VmStatCounters::pgfault},
+        {"pgmajfault", &VmStatCounters::pgmajfault},
+        {"pgscan_kswapd", &VmStatCounters::pgscan},
+        {"pgscan_direct", &VmStatCounters::pgscan},
+        {"pgscan_khugepaged", &VmStatCounters::pgscan},
+        {"pgsteal_kswapd", &VmStatCounters::pgsteal},
+        {"pgsteal_direct", &VmStatCounters::pgsteal},
+        {"pgsteal_khugepaged", &VmStatCounters::pgsteal},
+        {"pswpin", &VmStatCounters::pswpin},
+        {"pswpout", &VmStatCounters::pswpout},
+        {"workingset_refault", &VmStatCounters::refault},
+        {"workingset_refault_anon", &VmStatCounters::refault},
+        {"workingset_refault_file", &VmStatCounters::refault},
+    };
+    out = VmStatCounters();
+    bool found = false;
+    const char* p = buf;
+    const char* end = buf + len;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+        const char* sp = static_cast<const char*>(memchr(p, ' ', (size_t)(eol - p)));
+        if (sp) {
+            size_t key_len = (size_t)(sp - p);
+            for (const auto& k : keys) {
+                if (strlen(k.key) != key_len || memcmp(p, k.key, key_len) != 0) continue;
+                unsigned long long v = 0;
+                parseDecimal(skipBlanks(sp, eol), eol, v);
+                out.*k.field += v;
+                if (k.field == &VmStatCounters::pgfault) found = true;
+                break;
+            }
+        }
+        p = eol + 1;
+    }
+    return found;
+}
+
+size_t formatProcPath(char* out, int pid, const char* leaf) {
+    static const char prefix[] = "/proc/";
+    memcpy(out, prefix, sizeof(prefix) - 1);
+    size_t n = sizeof(prefix) - 1;
+
+    char digits[12];
+    int nd = 0;
+    unsigned int v = (pid < 0) ? 0u : (unsigned int)pid;
+    do { digits[nd++] = (char)('0' + v % 10); v /= 10; } while (v);
+    while (nd) out[n++] = digits[--nd];
+
+    out[n++] = '/';
+    size_t leaf_len = strlen(leaf);
+    memcpy(out + n, leaf, leaf_len);
+    n += leaf_len;
+    out[n] = '\0';
+    return n;
+}
+
+ssize_t preadProcFd(int fd, char* buf, size_t cap, unsigned long* syscalls) {
+    if (cap == 0) return -1;
+    size_t total = 0;
+    while (total < cap - 1) {
+        ssize_t n = ::pread(fd, buf + total, cap - 1 - total, (off_t)total);
+        if (syscalls) ++*syscalls;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        total += (size_t)n;
+        // a stat file is one line produced in one go: a short read ending in
+        // the newline is all of it, so the EOF read can be skipped
+        if ((size_t)n < cap - 1 - (total - (size_t)n) && buf[total - 1] == '\n') break;
+    }
+    buf[total] = '\0';
+    return (ssize_t)total;
+}
+
+StatFdCache::~StatFdCache() {
+    clear();
+}
+
+void StatFdCache::setLimit(size_t requested) {
+    // leave room for the ncurses terminal, debug log, /proc readers etc.
+    const size_t headroom = 128;
+    size_t allowed = 0;
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+        allowed = (rl.rlim_cur > headroom) ? (size_t)rl.rlim_cur - headroom : 0;
+    } else {
+        allowed = 65536;
+    }
+    max_fds = (requested == 0) ? allowed : std::min(requested, allowed);
+
+    // shrink immediately if the new cap is below the current population
+    for (auto it = fds.begin(); it != fds.end() && fds.size() > max_fds; ) {
+        ::close(it->second.fd);
+        it = fds.erase(it);
+        ++stats.evictions;
+    }
+}
+
+int StatFdCache::lookup(int pid) {
+    auto it = fds.find(pid);
+    if (it == fds.end()) return -1;
+    it->second.generation = generation;
+    return it->second.fd;
+}
+
+void StatFdCache::commit(int pid, bool hit, bool dead, bool opened, int new_fd) {
+    if (hit) ++stats.hits;
+    if (opened) ++stats.opens;
+    if (dead) {
+        auto it = fds.find(pid);
+        if (it != fds.end()) {
+            ::close(it->second.fd);
+            fds.erase(it);
+            ++stats.evictions;
+        }
+    }
+    if (new_fd < 0) return;
+    if (fds.size() >= max_fds) {
+        ::close(new_fd);
+        ++stats.uncached;
+        return;
+    }
+    Entry& e = fds[pid];
+    e.fd = new_fd;
+    e.generation = generation;
+}
+
+void StatFdCache::sweep() {
+    for (auto it = fds.begin(); it != fds.end(); ) {
+        if (it->second.generation != generation) {
+            ::close(it->second.fd);
+            it = fds.erase(it);
+            ++stats.evictions;
+        } else {
+            ++it;
+        }
+    }
+    ++generation;
+    last_stats = stats;
+    stats = Stats();
+}
+
+void StatFdCache::clear() {
+    for (auto& kv : fds) ::close(kv.second.fd);
+    fds.clear();
+}
+
+// Layout of the records returned by getdents64(2)
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+PidEnumerator::PidEnumerator(const char* dir) : path(dir), buf(64 * 1024) {}
+
+PidEnumerator::~PidEnumerator() {
+    if (dir_fd >= 0) ::close(dir_fd);
+}
+
+bool PidEnumerator::list(std::vector<int>& out) {
+    out.clear();
+    if (dir_fd < 0) {
+        dir_fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd < 0) return false;
+    } else if (::lseek(dir_fd, 0, SEEK_SET) < 0) {
+        ::close(dir_fd);
+        dir_fd = -1;
+        return false;
+    }
+
+    last_calls = 0;
+    for (;;) {
+        long n = ::syscall(SYS_getdents64, dir_fd, buf.data(), buf.size());
+        ++last_calls;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // e.g. the task directory of an exited process
+            ::close(dir_fd);
+            dir_fd = -1;
+            out.clear();
+            return false;
+        }
+        if (n == 0) break;
+        for (long off = 0; off < n; ) {
+            const LinuxDirent64* d = reinterpret_cast<const LinuxDirent64*>(buf.data() + off);
+            off += d->d_reclen;
+            if (d->d_type != DT_DIR && d->d_type != DT_UNKNOWN) continue;
+            const char* p = d->d_name;
+            if ((unsigned)(*p - '0') >= 10u) continue;
+            unsigned int v = 0;
+            while ((unsigned)(*p - '0') < 10u) v = v * 10 + (unsigned)(*p++ - '0');
+            if (*p != '\0') continue;
+            out.push_back((int)v);
+        }
+    }
+    // procfs already returns PIDs in ascending order; only sort if it didn't
+    if (!std::is_sorted(out.begin(), out.end())) std::sort(out.begin(), out.end());
+    return true;
+}
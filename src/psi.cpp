@@ -0,0 +1,75 @@
+#include "../include/psi.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+const char* psiResourceName(int resource) {
+    static const char* const names[PsiResourceCount] = {"cpu", "memory", "io"};
+    return (resource >= 0 && resource < PsiResourceCount) ? names[resource] : "?";
+}
+
+// some avg10=0.12 avg60=0.05 avg300=0.01 total=123456
+static bool parseLine(const char* p, PsiAverages& out) {
+    return sscanf(p, "%*s avg10=%f avg60=%f avg300=%f total=%llu",
+                  &out.avg10, &out.avg60, &out.avg300, &out.total_us) == 4;
+}
+
+bool parsePressure(const char* buf, size_t len, PsiResource& out) {
+    out = PsiResource();
+    bool some = false;
+    const char* p = buf;
+    const char* end = buf + len;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+        if (eol - p > 5 && memcmp(p, "some ", 5) == 0) some = parseLine(p, out.some);
+        else if (eol - p > 5 && memcmp(p, "full ", 5) == 0) out.has_full = parseLine(p, out.full);
+        p = eol + 1;
+    }
+    return some;
+}
+
+bool parsePsiTriggerSpec(const std::string& text, PsiTriggerSpec& out) {
+    char res[16], kind[8];
+    int stall = 0, window = 1000;
+    int n = sscanf(text.c_str(), "%15[^:]:%7[^:]:%d:%d", res, kind, &stall, &window);
+    if (n < 3) return false;
+    PsiTriggerSpec spec;
+    spec.resource = -1;
+    for (int r = 0; r < PsiResourceCount; ++r)
+        if (strcmp(res, psiResourceName(r)) == 0) spec.resource = r;
+    if (spec.resource < 0) return false;
+    if (strcmp(kind, "full") == 0) spec.full = true;
+    else if (strcmp(kind, "some") != 0) return false;
+    if (stall <= 0 || window <= 0 || stall > window) return false;
+    spec.stall_ms = stall;
+    spec.window_ms = window;
+    out = spec;
+    return true;
+}
+
+std::string describePsiTrigger(const PsiTriggerSpec& spec) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s %s %dms/%dms", psiResourceName(spec.resource),
+             spec.full ? "full" : "some", spec.stall_ms, spec.window_ms);
+    return buf;
+}
+
+int openPsiTrigger(const PsiTriggerSpec& spec) {
+    std::string path = std::string("/proc/pressure/") + psiResourceName(spec.resource);
+    int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+    // "<some|full> <stall us> <window us>", written with its terminating NUL
+    char cmd[64];
+    int n = snprintf(cmd, sizeof(cmd), "%s %lld %lld", spec.full ? "full" : "some",
+                     spec.stall_ms * 1000LL, spec.window_ms * 1000LL);
+    if (::write(fd, cmd, (size_t)n + 1) < 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
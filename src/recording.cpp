@@ -0,0 +1,469 @@
+#include "../include/recording.h"
+#include "../include/monitor.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kMagic[] = "AMREC\x1a\n"; // 7 bytes, then the version
+static const size_t kHeaderSize = 8;
+
+static void putVarint(OutBuf& out, uint64_t v) {
+    char b[10];
+    size_t n = 0;
+    while (v >= 0x80) {
+        b[n++] = (char)(v | 0x80);
+        v >>= 7;
+    }
+    b[n++] = (char)v;
+    out.put(b, n);
+}
+
+static uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+// 1/1000 fixed point; NaN and values out of range become 0
+static int64_t fixedPoint(double v) {
+    double x = v * 1000.0;
+    return (x > -9e18 && x < 9e18) ? (int64_t)std::llround(x) : 0;
+}
+
+// Every recorded field of a snapshot, in file order. The encoder reads
+// through it and the reader writes through it, so the two cannot disagree.
+template <class V, class S>
+static void walkFrame(V& v, S& s) {
+    v.integer(s.wall_ms);
+
+    v.real(s.cpu.total_usage);
+    v.integer(s.cpu.num_cores);
+    v.list(s.cpu.core_usage, [&](auto& c) { v.real(c); });
+
+    auto& m = s.memory;
+    v.integer(m.total);
+    v.integer(m.free);
+    v.integer(m.available);
+    v.integer(m.used);
+    v.real(m.percent_used);
+    v.integer(m.swap_total);
+    v.integer(m.swap_free);
+    v.integer(m.swap_used);
+    v.real(m.swap_percent_used);
+    v.integer(m.cached);
+    v.integer(m.buffers);
+    v.real(m.major_faults_per_sec);
+    v.real(m.minor_faults_per_sec);
+    v.real(m.pgscan_per_sec);
+    v.real(m.pgsteal_per_sec);
+    v.real(m.swap_in_per_sec);
+    v.real(m.swap_out_per_sec);
+    v.real(m.refaults_per_sec);
+    v.real(m.cache_effectiveness);
+
+    auto& sys = s.system;
+    v.real(sys.uptime_seconds);
+    v.real(sys.load_1min);
+    v.real(sys.load_5min);
+    v.real(sys.load_15min);
+    v.integer(sys.total_ctx_switches);
+    v.integer(sys.total_interrupts);
+    v.real(sys.ctx_switches_per_sec);
+    v.real(sys.interrupts_per_sec);
+    v.integer(sys.total_forks);
+    v.real(sys.forks_per_sec);
+    v.integer(sys.procs_running);
+    v.integer(sys.procs_blocked);
+
+    v.integer(s.pressure.available);
+    for (auto& r : s.pressure.resource) {
+        v.integer(r.has_full);
+        for (auto* a : {&r.some, &r.full}) {
+            v.real(a->avg10);
+            v.real(a->avg60);
+            v.real(a->avg300);
+            v.integer(a->total_us);
+        }
+    }
+
+    auto& io = s.diskio;
+    v.real(io.read_mb_per_sec);
+    v.real(io.write_mb_per_sec);
+    v.real(io.read_ops_per_sec);
+    v.real(io.write_ops_per_sec);
+    v.real(io.io_busy_percent);
+    v.list(io.devices, [&](auto& d) {
+        v.str(d.name);
+        v.str(d.mount_point);
+        v.integer(d.in_totals);
+        v.real(d.read_mb_per_sec);
+        v.real(d.write_mb_per_sec);
+        v.real(d.read_ops_per_sec);
+        v.real(d.write_ops_per_sec);
+        v.real(d.await_ms);
+        v.real(d.queue_depth);
+        v.real(d.util_percent);
+    });
+
+    auto& net = s.net;
+    v.real(net.rx_mb_per_sec);
+    v.real(net.tx_mb_per_sec);
+    v.real(net.rx_packets_per_sec);
+    v.real(net.tx_packets_per_sec);
+    v.real(net.drops_per_sec);
+    v.real(net.errors_per_sec);
+    v.list(net.interfaces, [&](auto& n) {
+        v.str(n.name);
+        v.integer(n.in_totals);
+        v.real(n.rx_mb_per_sec);
+        v.real(n.tx_mb_per_sec);
+        v.real(n.rx_packets_per_sec);
+        v.real(n.tx_packets_per_sec);
+        v.real(n.drops_per_sec);
+        v.real(n.errors_per_sec);
+        v.real(n.util_percent);
+    });
+
+    v.list(s.disks, [&](auto& d) {
+        v.str(d.device);
+        v.str(d.mount_point);
+        v.integer(d.total_space);
+        v.integer(d.free_space);
+        v.integer(d.used_space);
+        v.real(d.percent_used);
+        v.integer(d.stalled);
+    });
+
+    v.list(s.temperatures, [&](auto& t) {
+        v.str(t.first);
+        v.real(t.second);
+    });
+
+    v.procs(s.processes);
+}
+
+// ========================= ENCODER =========================
+void RecordEncoder::putHeader(OutBuf& out) {
+    out.put(kMagic, kHeaderSize - 1).put((char)kRecordVersion);
+}
+
+void RecordEncoder::encode(const MonitorSnapshot& s, uint32_t collectors, uint64_t t_ms, OutBuf& out) {
+    keyframe = frames % kKeyframeInterval == 0;
+    if (frames == 0) first_t = t_ms;
+    uint64_t t = std::max(last_t, t_ms > first_t ? t_ms - first_t : 0);
+    payload.clear();
+    new_strings.clear();
+    field = 0;
+    putVarint(payload, keyframe ? t : t - last_t);
+    putVarint(payload, collectors);
+    walkFrame(*this, s);
+
+    out.put(new_strings.data(), new_strings.size());
+    out.put(keyframe ? 'K' : 'D');
+    putVarint(out, payload.size());
+    out.put(payload.data(), payload.size());
+    last_t = t;
+    ++frames;
+}
+
+void RecordEncoder::integer(int64_t v) {
+    if (field == prev.size()) prev.push_back(0);
+    int64_t base = keyframe ? 0 : prev[field];
+    putVarint(payload, zigzag((int64_t)((uint64_t)v - (uint64_t)base)));
+    prev[field++] = v;
+}
+
+void RecordEncoder::real(double v) { integer(fixedPoint(v)); }
+
+void RecordEncoder::str(const std::string& s) { putVarint(payload, stringId(s)); }
+
+// A new string is queued as an 'S' record to go out before the frame
+uint32_t RecordEncoder::stringId(const std::string& s) {
+    auto it = strings.find(s);
+    if (it != strings.end()) return it->second;
+    uint32_t id = (uint32_t)strings.size();
+    strings.emplace(s, id);
+    new_strings.put('S');
+    putVarint(new_strings, s.size());
+    new_strings.put(s);
+    return id;
+}
+
+// Processes in PID order: the PID as a difference from the one before,
+// with the low bit set when the name follows; then CPU and memory as
+// differences from the same PID in the previous frame (0 if it is new)
+void RecordEncoder::procs(const std::vector<Process>& p) {
+    order.resize(p.size());
+    for (uint32_t i = 0; i < (uint32_t)p.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return p[a].pid < p[b].pid; });
+
+    putVarint(payload, p.size());
+    cur_procs.clear();
+    size_t j = 0;
+    int last_pid = 0;
+    for (uint32_t i : order) {
+        const Process& pr = p[i];
+        while (!keyframe && j < prev_procs.size() && prev_procs[j].pid < pr.pid) ++j;
+        const ProcState* old = (!keyframe && j < prev_procs.size() && prev_procs[j].pid == pr.pid) ? &prev_procs[j] : nullptr;
+        uint32_t name = stringId(pr.name);
+        ProcState st = {pr.pid, name, fixedPoint(pr.cpu_percent), fixedPoint(pr.mem_percent)};
+        bool with_name = !old || old->name != name;
+        putVarint(payload, ((uint64_t)(uint32_t)(pr.pid - last_pid) << 1) | (with_name ? 1 : 0));
+        if (with_name) putVarint(payload, name);
+        putVarint(payload, zigzag(st.cpu - (old ? old->cpu : 0)));
+        putVarint(payload, zigzag(st.mem - (old ? old->mem : 0)));
+        cur_procs.push_back(st);
+        last_pid = pr.pid;
+    }
+    prev_procs.swap(cur_procs);
+}
+
+// ========================= WRITER =========================
+RecordWriter::~RecordWriter() {
+    if (fd >= 0) ::close(fd);
+}
+
+bool RecordWriter::open(const std::string& path, std::string& error) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    out.clear();
+    RecordEncoder::putHeader(out);
+    if (::write(fd, out.data(), out.size()) != (ssize_t)out.size()) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool RecordWriter::append(const MonitorSnapshot& s, uint32_t collectors, uint64_t t_ms) {
+    out.clear();
+    encoder.encode(s, collectors, t_ms, out);
+    for (size_t done = 0; done < out.size();) {
+        ssize_t n = ::write(fd, out.data() + done, out.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += (size_t)n;
+    }
+    return true;
+}
+
+// ========================= READER =========================
+RecordReader::~RecordReader() {
+    if (map) munmap(map, map_len);
+}
+
+bool RecordReader::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)kHeaderSize) {
+        ::close(fd);
+        error = path + ": not a recording";
+        return false;
+    }
+    map_len = (size_t)st.st_size;
+    map = mmap(nullptr, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        map = nullptr;
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    if (!load(static_cast<const char*>(map), map_len, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+static bool readVarint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char b = (unsigned char)*p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+bool RecordReader::load(const char* buf, size_t size, std::string& error) {
+    if (size < kHeaderSize || memcmp(buf, kMagic, kHeaderSize - 1) != 0) {
+        error = "not a recording";
+        return false;
+    }
+    if ((unsigned char)buf[kHeaderSize - 1] != kRecordVersion) {
+        error = "recording version " + std::to_string((unsigned char)buf[kHeaderSize - 1]) +
+                " (this build reads " + std::to_string(kRecordVersion) + ")";
+        return false;
+    }
+    data = buf;
+    strings.clear();
+    keys.clear();
+    frame_count = 0;
+    duration_ms = 0;
+
+    // one pass for the string table and the keyframes; stops at the first
+    // incomplete record
+    const char* q = buf + kHeaderSize;
+    const char* stop = buf + size;
+    uint64_t t = 0;
+    while (q < stop) {
+        const char* rec = q;
+        char type = *q++;
+        uint64_t n;
+        if (!readVarint(q, stop, n) || n > (uint64_t)(stop - q)) {
+            q = rec;
+            break;
+        }
+        const char* body = q;
+        q += n;
+        if (type == 'S') {
+            strings.emplace_back(body, (size_t)n);
+        } else if (type == 'K' || type == 'D') {
+            uint64_t dt;
+            if (!readVarint(body, q, dt)) {
+                q = rec;
+                break;
+            }
+            if (type == 'K') {
+                t = dt;
+                keys.push_back({(size_t)(rec - buf), frame_count, t});
+            } else if (keys.empty()) {
+                error = "recording does not start with a keyframe";
+                return false;
+            } else {
+                t += dt;
+            }
+            ++frame_count;
+            duration_ms = t;
+        }
+        // other record types are skipped: later versions may add some
+    }
+    len = (size_t)(q - buf);
+    if (keys.empty()) {
+        error = "recording has no frames";
+        return false;
+    }
+    seek(0);
+    return true;
+}
+
+size_t RecordReader::keyframeBefore(size_t f) const {
+    auto it = std::upper_bound(keys.begin(), keys.end(), f,
+                               [](size_t v, const Keyframe& k) { return v < k.frame; });
+    return it == keys.begin() ? 0 : (size_t)(it - keys.begin()) - 1;
+}
+
+void RecordReader::seek(size_t k) {
+    k = std::min(k, keys.size() - 1);
+    off = keys[k].offset;
+    frame = keys[k].frame;
+    last_t = keys[k].t_ms;
+    prev_procs.clear();
+}
+
+bool RecordReader::nextFrameRecord(size_t at, char& type, const char*& body, const char*& body_end, size_t& after) const {
+    const char* stop = data + len;
+    const char* q = data + at;
+    while (q < stop) {
+        type = *q++;
+        uint64_t n;
+        if (!readVarint(q, stop, n)) return false;
+        body = q;
+        body_end = q + n;
+        q = body_end;
+        if (type == 'K' || type == 'D') {
+            after = (size_t)(q - data);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RecordReader::peekTime(uint64_t& t_ms) const {
+    char type;
+    const char *body, *body_end;
+    size_t after;
+    uint64_t dt;
+    if (!nextFrameRecord(off, type, body, body_end, after) || !readVarint(body, body_end, dt)) return false;
+    t_ms = (type == 'K') ? dt : last_t + dt;
+    return true;
+}
+
+bool RecordReader::next(MonitorSnapshot& out, uint32_t& collectors, uint64_t& t_ms) {
+    char type;
+    size_t after;
+    if (!nextFrameRecord(off, type, p, end, after)) return false;
+    keyframe = type == 'K';
+    bad = false;
+    field_index = 0;
+    uint64_t dt = varint();
+    uint64_t mask = varint();
+    walkFrame(*this, out);
+    if (bad) return false;
+
+    off = after;
+    ++frame;
+    last_t = t_ms = keyframe ? dt : last_t + dt;
+    collectors = (uint32_t)mask;
+    return true;
+}
+
+uint64_t RecordReader::varint() {
+    uint64_t v = 0;
+    if (!bad && !readVarint(p, end, v)) bad = true;
+    return bad ? 0 : v;
+}
+
+int64_t RecordReader::field() {
+    if (field_index == prev.size()) prev.push_back(0);
+    int64_t base = keyframe ? 0 : prev[field_index];
+    int64_t v = (int64_t)((uint64_t)base + (uint64_t)unzigzag(varint()));
+    prev[field_index++] = v;
+    return v;
+}
+
+void RecordReader::str(std::string& s) {
+    uint64_t id = varint();
+    if (id >= strings.size()) {
+        bad = true;
+        return;
+    }
+    s.assign(strings[id]);
+}
+
+void RecordReader::procs(std::vector<Process>& out) {
+    uint64_t n = varint();
+    if (bad || n > (uint64_t)(end - p)) {
+        bad = true;
+        return;
+    }
+    out.resize((size_t)n);
+    cur_procs.clear();
+    size_t j = 0;
+    int pid = 0;
+    for (Process& pr : out) {
+        uint64_t head = varint();
+        pid += (int)(uint32_t)(head >> 1);
+        while (!keyframe && j < prev_procs.size() && prev_procs[j].pid < pid) ++j;
+        const ProcState* old = (!keyframe && j < prev_procs.size() && prev_procs[j].pid == pid) ? &prev_procs[j] : nullptr;
+        uint32_t name = (head & 1) ? (uint32_t)varint() : (old ? old->name : (uint32_t)~0u);
+        if (name >= strings.size()) bad = true;
+        if (bad) return;
+        ProcState st = {pid, name, (old ? old->cpu : 0) + unzigzag(varint()), (old ? old->mem : 0) + unzigzag(varint())};
+        pr.pid = pid;
+        pr.name.assign(strings[name]);
+        pr.cpu_percent = (float)(st.cpu / 1000.0);
+        pr.mem_percent = (float)(st.mem / 1000.0);
+        cur_procs.push_back(st);
+    }
+    prev_procs.swap(cur_procs);
+}
@@ -0,0 +1,27 @@
+#include "../include/self_stats.h"
+#include "../include/procfs.h"
+#include <cstring>
+
+bool readSelfUsage(SelfUsage& out) {
+    char buf[1024];
+    ssize_t n = readProcFile("/proc/self/stat", buf, sizeof(buf));
+    ProcStatFields f;
+    if (n <= 0 || !parseProcStat(buf, (size_t)n, f)) return false;
+    out.cpu_ticks = f.utime + f.stime;
+    out.rss_pages = f.rss_pages;
+    out.minor_faults = f.minflt;
+
+    // /proc/self/io may be missing (no task I/O accounting); keep the rest
+    out.syscalls = 0;
+    n = readProcFile("/proc/self/io", buf, sizeof(buf));
+    if (n > 0) {
+        const char* end = buf + n;
+        unsigned long long reads = 0, writes = 0;
+        const char* p = strstr(buf, "syscr:");
+        if (p) parseDecimal(p + 7, end, reads);
+        p = strstr(buf, "syscw:");
+        if (p) parseDecimal(p + 7, end, writes);
+        out.syscalls = reads + writes;
+    }
+    return true;
+}
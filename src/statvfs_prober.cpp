@@ -0,0 +1,182 @@
+#include "../include/statvfs_prober.h"
+#include "../include/self_stats.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+#include <sys/statvfs.h>
+
+static const uint64_t kBackoffMinNs = 5000000000ULL;   // 5 s
+static const uint64_t kBackoffMaxNs = 300000000000ULL; // 5 min
+
+struct StatvfsProber::Job {
+    std::string path;
+    // guarded by Shared::mu
+    uint64_t started_ns = 0; // 0 while queued
+    bool done = false;
+    bool stuck = false;      // counted in Shared::stuck
+    int err = 0;
+    FsSpace space;
+};
+
+// Everything the helpers touch; they keep it alive after the prober is gone
+struct StatvfsProber::Shared {
+    std::mutex mu;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::deque<std::shared_ptr<Job>> queue;
+    int threads = 0;
+    int idle = 0;
+    int stuck = 0; // helpers whose call missed its deadline
+    bool stop = false;
+};
+
+StatvfsProber::StatvfsProber(int max_threads)
+    : shared(std::make_shared<Shared>()), max_threads(std::max(1, max_threads)) {}
+
+StatvfsProber::~StatvfsProber() {
+    std::lock_guard<std::mutex> lock(shared->mu);
+    shared->stop = true;
+    shared->queue.clear();
+    shared->work_cv.notify_all();
+}
+
+void StatvfsProber::helperMain(std::shared_ptr<Shared> sh) {
+    std::unique_lock<std::mutex> lock(sh->mu);
+    for (;;) {
+        // idle: counted by spawnHelpers() at first, then after each call
+        sh->work_cv.wait(lock, [&] { return sh->stop || !sh->queue.empty(); });
+        --sh->idle;
+        if (sh->stop) break;
+        std::shared_ptr<Job> job = sh->queue.front();
+        sh->queue.pop_front();
+        job->started_ns = monotonicNs();
+        lock.unlock();
+
+        struct statvfs st;
+        int err = (statvfs(job->path.c_str(), &st) == 0) ? 0 : errno;
+        FsSpace space;
+        if (!err) {
+            unsigned long block_size = st.f_frsize;
+            space.total_kb = (st.f_blocks * block_size) / 1024;
+            space.free_kb = (st.f_bfree * block_size) / 1024;
+        }
+
+        lock.lock();
+        job->err = err;
+        job->space = space;
+        job->done = true;
+        if (job->stuck) --sh->stuck;
+        ++sh->idle;
+        sh->done_cv.notify_all();
+    }
+    --sh->threads;
+}
+
+// Fold a finished call into the cache (mu held)
+void StatvfsProber::harvest(Mount& m, bool in_time) {
+    if (!m.job || !m.job->done) return;
+    if (m.job->err == 0) {
+        m.entry.space = m.job->space;
+        m.entry.valid = true;
+        m.entry.failed = false;
+    } else {
+        m.entry.valid = false;
+        m.entry.failed = true;
+    }
+    m.entry.stalled = false;
+    if (in_time) m.entry.stalls = 0; // a late answer keeps the backoff
+    m.job.reset();
+}
+
+// Start helpers for queued calls, not counting stuck ones against
+// max_threads (mu held)
+void StatvfsProber::spawnHelpers() {
+    Shared& sh = *shared;
+    while ((int)sh.queue.size() > sh.idle && sh.threads - sh.stuck < max_threads && sh.threads < 4 * max_threads) {
+        try {
+            std::thread(helperMain, shared).detach();
+        } catch (const std::system_error&) {
+            return; // no new helper: the calls wait for a free one
+        }
+        ++sh.threads;
+        ++sh.idle; // counted as idle until it takes a call
+    }
+}
+
+void StatvfsProber::refresh(const std::vector<std::string>& paths) {
+    uint64_t now = monotonicNs();
+    uint64_t deadline = now + (uint64_t)timeout_ms * 1000000ULL;
+    std::vector<Mount*> waiting;
+    std::unordered_set<std::string> listed;
+
+    std::unique_lock<std::mutex> lock(shared->mu);
+    for (const std::string& path : paths) {
+        if (!listed.insert(path).second) continue;
+        Mount& m = mounts[path];
+        harvest(m, false);
+        if (m.job) {
+            // queued behind stuck helpers, or running but not stuck yet
+            if (!m.job->stuck) waiting.push_back(&m);
+            continue;
+        }
+        if (now < m.entry.retry_ns) continue; // backing off
+        m.job = std::make_shared<Job>();
+        m.job->path = path;
+        shared->queue.push_back(m.job);
+        spawnHelpers();
+        shared->work_cv.notify_one();
+        waiting.push_back(&m);
+    }
+
+    auto all_done = [&] {
+        for (Mount* m : waiting)
+            if (!m->job->done) return false;
+        return true;
+    };
+    shared->done_cv.wait_for(lock, std::chrono::nanoseconds(deadline - now), all_done);
+
+    for (Mount* m : waiting) harvest(*m, true);
+
+    for (auto it = mounts.begin(); it != mounts.end();) {
+        if (listed.count(it->first)) {
+            ++it;
+            continue;
+        }
+        // an outstanding job lives on in its helper, which no one waits for
+        Job* job = it->second.job.get();
+        if (job && job->started_ns && !job->done && !job->stuck) {
+            job->stuck = true;
+            ++shared->stuck;
+        }
+        it = mounts.erase(it);
+    }
+
+    // A call running past the timeout (this refresh's or one queued behind
+    // stuck helpers earlier) stalls its mount: serve the cache and back off.
+    // Its helper stops counting toward max_threads.
+    now = monotonicNs();
+    for (auto& it : mounts) {
+        Mount& m = it.second;
+        Job* job = m.job.get();
+        if (!job || job->done || job->stuck || !job->started_ns) continue;
+        if (now - job->started_ns < (uint64_t)timeout_ms * 1000000ULL) continue;
+        job->stuck = true;
+        ++shared->stuck;
+        m.entry.stalled = true;
+        uint64_t backoff = kBackoffMinNs << std::min(m.entry.stalls, 6u);
+        m.entry.retry_ns = now + std::min(backoff, kBackoffMaxNs);
+        ++m.entry.stalls;
+    }
+    spawnHelpers(); // replacements for the calls still queued
+}
+
+const StatvfsProber::Entry* StatvfsProber::find(const std::string& path) const {
+    auto it = mounts.find(path);
+    return (it == mounts.end()) ? nullptr : &it->second.entry;
+}
@@ -0,0 +1,130 @@
+#include "../include/surface.h"
+#include <ncurses.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+int Surface::print(int y, int x, Style st, const char* fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return x;
+    return text(y, x, buf, std::min((size_t)n, sizeof(buf) - 1), st);
+}
+
+void Surface::box(int y, int x, int h, int w, Style st) {
+    if (h < 2 || w < 2) return;
+    for (int i = 1; i < w - 1; ++i) {
+        put(y, x + i, makeCell(Glyph::HLine, st));
+        put(y + h - 1, x + i, makeCell(Glyph::HLine, st));
+    }
+    for (int i = 1; i < h - 1; ++i) {
+        put(y + i, x, makeCell(Glyph::VLine, st));
+        put(y + i, x + w - 1, makeCell(Glyph::VLine, st));
+    }
+    put(y, x, makeCell(Glyph::ULCorner, st));
+    put(y, x + w - 1, makeCell(Glyph::URCorner, st));
+    put(y + h - 1, x, makeCell(Glyph::LLCorner, st));
+    put(y + h - 1, x + w - 1, makeCell(Glyph::LRCorner, st));
+}
+
+void Surface::frame(const char* title) {
+    box(0, 0, height(), width());
+    print(0, 2, Style(5), " %s ", title);
+}
+
+// ------------------------------------------------------------ ncurses
+
+static WINDOW* toWin(void* p) { return static_cast<WINDOW*>(p); }
+
+static attr_t toAttr(Style st) {
+    attr_t a = COLOR_PAIR(st.pair);
+    if (st.attrs & AttrBold) a |= A_BOLD;
+    if (st.attrs & AttrDim) a |= A_DIM;
+    if (st.attrs & AttrReverse) a |= A_REVERSE;
+    return a;
+}
+
+static chtype toChtype(Cell c) {
+    chtype ch = cellChar(c);
+    if (cellIsGlyph(c)) {
+        switch ((Glyph)cellChar(c)) {
+        case Glyph::Bullet: ch = ACS_BULLET; break;
+        case Glyph::Checkerboard: ch = ACS_CKBOARD; break;
+        case Glyph::VLine: ch = ACS_VLINE; break;
+        case Glyph::HLine: ch = ACS_HLINE; break;
+        case Glyph::ULCorner: ch = ACS_ULCORNER; break;
+        case Glyph::URCorner: ch = ACS_URCORNER; break;
+        case Glyph::LLCorner: ch = ACS_LLCORNER; break;
+        case Glyph::LRCorner: ch = ACS_LRCORNER; break;
+        }
+    }
+    return ch | toAttr(cellStyle(c));
+}
+
+int NcursesSurface::height() const { return getmaxy(toWin(win)); }
+int NcursesSurface::width() const { return getmaxx(toWin(win)); }
+void NcursesSurface::erase() { werase(toWin(win)); }
+void NcursesSurface::stage() { wnoutrefresh(toWin(win)); }
+
+void NcursesSurface::put(int y, int x, Cell c) {
+    if (y < 0 || x < 0 || y >= height() || x >= width()) return;
+    mvwaddch(toWin(win), y, x, toChtype(c));
+}
+
+int NcursesSurface::text(int y, int x, const char* s, size_t n, Style st) {
+    WINDOW* w = toWin(win);
+    int wid = getmaxx(w);
+    if (y < 0 || x < 0 || y >= getmaxy(w) || x >= wid) return x + (int)n;
+    int len = std::min((int)n, wid - x);
+    wattrset(w, toAttr(st));
+    mvwaddnstr(w, y, x, s, len);
+    wattrset(w, A_NORMAL);
+    return x + (int)n;
+}
+
+// ------------------------------------------------------------ grid
+
+void GridSurface::resize(int height, int width) {
+    h = std::max(0, height);
+    w = std::max(0, width);
+    cells.assign((size_t)h * w, makeCell(' '));
+}
+
+void GridSurface::erase() {
+    std::fill(cells.begin(), cells.end(), makeCell(' '));
+}
+
+void GridSurface::put(int y, int x, Cell c) {
+    if (y < 0 || x < 0 || y >= h || x >= w) return;
+    cells[(size_t)y * w + x] = c;
+}
+
+int GridSurface::text(int y, int x, const char* s, size_t n, Style st) {
+    if (y < 0 || y >= h || x < 0) return x + (int)n;
+    int len = std::min((int)n, w - x);
+    Cell* row = &cells[(size_t)y * w];
+    for (int i = 0; i < len; ++i) row[x + i] = makeCell(s[i], st);
+    return x + (int)n;
+}
+
+std::string GridSurface::row(int y) const {
+    std::string out((size_t)w, ' ');
+    for (int x = 0; x < w; ++x) {
+        Cell c = at(y, x);
+        if (!cellIsGlyph(c)) {
+            out[x] = (char)cellChar(c);
+            continue;
+        }
+        switch ((Glyph)cellChar(c)) {
+        case Glyph::Bullet: out[x] = '*'; break;
+        case Glyph::Checkerboard: out[x] = '#'; break;
+        case Glyph::VLine: out[x] = '|'; break;
+        case Glyph::HLine: out[x] = '-'; break;
+        default: out[x] = '+'; break;
+        }
+    }
+    return out;
+}
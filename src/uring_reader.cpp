@@ -0,0 +1,123 @@
+#include "../include/uring_reader.h"
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int sysUringSetup(unsigned entries, struct io_uring_params* p) {
+    return (int)::syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sysUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static inline unsigned loadAcquire(const unsigned* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void storeRelease(unsigned* p, unsigned v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+UringReader::~UringReader() {
+    shutdown();
+}
+
+void UringReader::shutdown() {
+    if (sqes_ptr) munmap(sqes_ptr, sqes_len);
+    if (cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr, cq_len);
+    if (sq_ptr) munmap(sq_ptr, sq_len);
+    if (ring_fd >= 0) ::close(ring_fd);
+    sqes_ptr = cq_ptr = sq_ptr = nullptr;
+    ring_fd = -1;
+    sq_entries = 0;
+    queued = 0;
+}
+
+bool UringReader::init(unsigned entries) {
+    shutdown();
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = sysUringSetup(entries, &p);
+    if (fd < 0) return false;
+    ring_fd = fd;
+    sq_entries = p.sq_entries;
+
+    sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) sq_len = cq_len = (sq_len > cq_len) ? sq_len : cq_len;
+
+    sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) { sq_ptr = nullptr; int e = errno; shutdown(); errno = e; return false; }
+    if (single_mmap) {
+        cq_ptr = sq_ptr;
+    } else {
+        cq_ptr = mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) { cq_ptr = nullptr; int e = errno; shutdown(); errno = e; return false; }
+    }
+    sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ptr = mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes_ptr == MAP_FAILED) { sqes_ptr = nullptr; int e = errno; shutdown(); errno = e; return false; }
+
+    char* sq = static_cast<char*>(sq_ptr);
+    char* cq = static_cast<char*>(cq_ptr);
+    sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes = cq + p.cq_off.cqes;
+    return true;
+}
+
+bool UringReader::queueRead(int fd, char* buf, unsigned len, uint64_t user_data) {
+    if (ring_fd < 0 || queued >= sq_entries) return false;
+    unsigned tail = *sq_tail;
+    unsigned idx = tail & *sq_mask;
+    struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_ptr) + idx;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = 0;
+    sqe->user_data = user_data;
+    sq_array[idx] = idx;
+    storeRelease(sq_tail, tail + 1);
+    ++queued;
+    return true;
+}
+
+int UringReader::submitAndWait(CompletionFn on_complete, void* ctx) {
+    if (ring_fd < 0) return -1;
+    unsigned want = queued;
+    unsigned to_submit = queued;
+    int reaped = 0;
+    while ((unsigned)reaped < want) {
+        int r = sysUringEnter(ring_fd, to_submit, want - (unsigned)reaped, IORING_ENTER_GETEVENTS);
+        ++enter_calls;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        to_submit -= (unsigned)r < to_submit ? (unsigned)r : to_submit;
+
+        unsigned head = *cq_head;
+        unsigned tail = loadAcquire(cq_tail);
+        while (head != tail) {
+            const struct io_uring_cqe* cqe = static_cast<const struct io_uring_cqe*>(cqes) + (head & *cq_mask);
+            on_complete(ctx, cqe->user_data, cqe->res);
+            ++head;
+            ++reaped;
+        }
+        storeRelease(cq_head, head);
+    }
+    queued = 0;
+    return reaped;
+}
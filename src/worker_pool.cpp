@@ -0,0 +1,65 @@
+#include "../include/worker_pool.h"
+
+WorkerPool::~WorkerPool() {
+    stopAll();
+}
+
+void WorkerPool::stopAll() {
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        stopping = true;
+    }
+    cv_start.notify_all();
+    for (auto& t : workers) t.join();
+    workers.clear();
+    stopping = false;
+}
+
+void WorkerPool::resize(size_t threads) {
+    if (threads == 0) threads = 1;
+    if (threads == size()) return;
+    stopAll();
+    // hand each worker the current generation so a run() issued before the
+    // thread gets scheduled is not missed
+    for (size_t id = 1; id < threads; ++id) workers.emplace_back(&WorkerPool::workerLoop, this, id, job_generation);
+}
+
+void WorkerPool::run(size_t shards, const std::function<void(size_t)>& fn) {
+    if (shards == 0) return;
+    if (shards > size()) shards = size();
+    if (shards > 1) {
+        std::lock_guard<std::mutex> lk(mu);
+        job = &fn;
+        job_shards = shards;
+        pending = shards - 1;
+        ++job_generation;
+    }
+    if (shards > 1) cv_start.notify_all();
+
+    fn(0);
+
+    if (shards > 1) {
+        std::unique_lock<std::mutex> lk(mu);
+        cv_done.wait(lk, [this] { return pending == 0; });
+        job = nullptr;
+    }
+}
+
+void WorkerPool::workerLoop(size_t id, uint64_t seen) {
+    for (;;) {
+        const std::function<void(size_t)>* fn = nullptr;
+        {
+            std::unique_lock<std::mutex> lk(mu);
+            cv_start.wait(lk, [&] { return stopping || job_generation != seen; });
+            if (stopping) return;
+            seen = job_generation;
+            if (id >= job_shards) continue;
+            fn = job;
+        }
+        (*fn)(id);
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            if (--pending == 0) cv_done.notify_one();
+        }
+    }
+}